@@ -0,0 +1,582 @@
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstdio>
+
+#include "clam.hpp"
+
+// Runs `f` over `args` `rounds` times and reports nanoseconds per argument
+template <typename F>
+static void
+bench(const char *name, const char *const *args, std::size_t count, std::size_t rounds, F f)
+{
+        clam_match_result_t sink = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (std::size_t r = 0; r < rounds; r++) {
+                for (std::size_t i = 0; i < count; i++) {
+                        sink += f(args[i]);
+                }
+                asm volatile("" : "+r"(sink));
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        double ns = std::chrono::duration<double, std::nano>(elapsed).count();
+        printf("| %-40s | %8.2f ns/arg | %lu |\n", name, ns / (double)(count * rounds),
+               (unsigned long)sink);
+}
+
+// Runs `f` over `length` bytes `rounds` times and reports throughput
+template <typename F>
+static void
+bench_bytes(const char *name, std::size_t length, std::size_t rounds, F f)
+{
+        std::size_t sink = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (std::size_t r = 0; r < rounds; r++) {
+                // The buffer may have changed, so a pure `f` cannot be hoisted
+                asm volatile("" ::: "memory");
+                sink += f();
+                asm volatile("" : "+r"(sink));
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        double s = std::chrono::duration<double>(elapsed).count();
+        printf("| %-40s | %7.2f GB/s | %lu |\n", name, (double)(length * rounds) / s / 1e9,
+               (unsigned long)sink);
+}
+
+static const char *const args[] = {
+        "--link=foo", "-lbar", "--help", "-link", "baz", "--linker", "-h",
+        "--verbose", "-l", "--link", "input.c", "-o", "output", "--list",
+};
+
+static clam_match_result_t
+hand_written(const char *arg)
+{
+        clam_match_result_t i;
+        if ((i = clam_match_posix_long_option(arg, "-link")) ||
+            (i = clam_match_posix_long_option(arg, "link")) ||
+            (i = clam_match_posix_long_option(arg, "l"))) {
+                return i + clam_match_char(arg + i, '=');
+        }
+        if ((i = clam_match_posix_long_option(arg, "-help")) ||
+            (i = clam_match_posix_long_option(arg, "h"))) {
+                return i;
+        }
+        return 0;
+}
+
+static clam_match_result_t
+combinators(const char *arg)
+{
+        using namespace clam;
+        static constexpr auto p =
+                alt(seq(alt(lit<"--link">, lit<"-link">, lit<"-l">), opt(lit<"=">)),
+                    alt(lit<"--help">, lit<"-h">));
+        return p(arg);
+}
+
+static clam_dfa_t link_dfa;
+static std::uint16_t link_table[1024];
+
+static clam_match_result_t
+hand_written_link(const char *arg)
+{
+        clam_match_result_t i;
+        if ((i = clam_match_posix_long_option(arg, "-link")) ||
+            (i = clam_match_posix_long_option(arg, "link")) ||
+            (i = clam_match_posix_long_option(arg, "l"))) {
+                return i + clam_match_char(arg + i, '=');
+        }
+        return 0;
+}
+
+static clam_match_result_t
+dfa_link(const char *arg)
+{
+        return clam_match_dfa(arg, &link_dfa);
+}
+
+#define DRIVER_OPTIONS(X) X(define, "-define") X(include, "-include") X(output, "o")
+
+CLAM_SCHEMA(driver_option, driver_options, DRIVER_OPTIONS);
+
+// 300 applet names (`ap000`..`ap299`) for a multi-call binary
+static constexpr auto applet_storage = [] {
+        std::array<std::array<char, 6>, 300> storage{};
+        for (int i = 0; i < 300; i++) {
+                storage[i] = {'a', 'p', char('0' + i / 100), char('0' + i / 10 % 10), char('0' + i % 10)};
+        }
+        return storage;
+}();
+
+struct applet_list {
+        std::string_view names[300];
+};
+
+static constexpr applet_list applet_list = [] {
+        struct applet_list list{};
+        for (int i = 0; i < 300; i++) {
+                list.names[i] = std::string_view(applet_storage[i].data(), 5);
+        }
+        return list;
+}();
+
+static constexpr auto applets = clam::make_schema<int>(applet_list.names);
+
+int main()
+{
+        const std::size_t count = sizeof(args) / sizeof(args[0]);
+        const std::size_t rounds = 2000000;
+
+        printf("# Matcher combinators\n\n");
+        printf("| %-40s | %15s | |\n", "benchmark", "time");
+        printf("|------------------------------------------|-----------------|-|\n");
+        bench("hand-written `clam_match_*` chain", args, count, rounds, hand_written);
+        bench("combinators", args, count, rounds, combinators);
+
+        clam_pattern_node_t nodes[16];
+        clam_pattern_t p;
+        clam_pattern_init(&p, nodes, 16);
+        int link = clam_pattern_sequence(&p,
+                      clam_pattern_alternation(&p,
+                        clam_pattern_alternation(&p,
+                          clam_pattern_literal(&p, "--link"),
+                          clam_pattern_literal(&p, "-link")),
+                        clam_pattern_literal(&p, "-l")),
+                      clam_pattern_repeat(&p, clam_pattern_anychar(&p, "="), 0, 1));
+        if (clam_dfa_compile(&link_dfa, link_table, 1024, &p, link) != CLAM_ERROR_NONE) {
+                return 1;
+        }
+
+        printf("\n# Runtime patterns\n\n");
+        printf("| %-40s | %15s | |\n", "benchmark", "time");
+        printf("|------------------------------------------|-----------------|-|\n");
+        bench("hand-written `clam_match_*` chain", args, count, rounds, hand_written_link);
+        bench("`clam_match_dfa`", args, count, rounds, dfa_link);
+
+        static const char *const addresses[] = {"192.168.0.1", "10.0.0.254", "8.8.8.8", "172.16.254.3",
+                                                "255.255.255.0", "127.0.0.1", "100.64.12.200", "1.2.3.4"};
+        printf("\n# IPv4 addresses\n\n");
+        printf("| %-40s | %15s | |\n", "benchmark", "time");
+        printf("|------------------------------------------|-----------------|-|\n");
+        bench("`inet_pton`", addresses, 8, rounds, [](const char *arg) -> clam_match_result_t {
+                std::uint8_t address[4];
+                return inet_pton(AF_INET, arg, address) == 1 ? address[3] : 0;
+        });
+        bench("`clam_match_ipv4`", addresses, 8, rounds, [](const char *arg) -> clam_match_result_t {
+                std::uint8_t address[4];
+                return clam_match_ipv4(arg, address) ? address[3] : 0;
+        });
+
+        static const char *const uuids[] = {"123e4567-e89b-12d3-a456-426614174000",
+                                            "f47ac10b-58cc-4372-a567-0e02b2c3d479",
+                                            "9c5b94b1-35ad-49bb-b118-8e8fc24abf80",
+                                            "6ba7b810-9dad-11d1-80b4-00c04fd430c8"};
+        printf("\n# UUIDs\n\n");
+        printf("| %-40s | %15s | |\n", "benchmark", "time");
+        printf("|------------------------------------------|-----------------|-|\n");
+        bench("per-character loop", uuids, 4, rounds, [](const char *arg) -> clam_match_result_t {
+                std::uint8_t uuid[16];
+                clam_match_result_t i = 0;
+                for (int k = 0; k < 32; k++) {
+                        if (i == 8 || i == 13 || i == 18 || i == 23) {
+                                if (arg[i++] != '-') {
+                                        return 0;
+                                }
+                        }
+                        if (!clam_match_numeric16_char(arg + i)) {
+                                return 0;
+                        }
+                        char c = clam__fold_char(arg[i++]);
+                        unsigned nibble = c <= '9' ? c - '0' : c - 'a' + 10;
+                        uuid[k / 2] = k % 2 ? uuid[k / 2] | nibble : nibble << 4;
+                }
+                return uuid[15];
+        });
+        bench("`clam_match_uuid`", uuids, 4, rounds, [](const char *arg) -> clam_match_result_t {
+                std::uint8_t uuid[16];
+                return clam_match_uuid(arg, uuid) ? uuid[15] : 0;
+        });
+
+        static const char *const flags[] = {"--no-verify", "-Werror", "--force", "--insecure"};
+        static const char *const words[] = {"gcc", "-O2", "-Wall", "-c", "src/main.c", "-o",
+                                            "build/main.o", "--verbose", "-Werror", "make[2]:",
+                                            "Entering", "directory", "'/home/build'", "\n"};
+        std::size_t length = 64 << 20;
+        char *text = new char[length];
+        std::size_t n = 0;
+        unsigned seed = 1;
+        while (n < length) {
+                seed = seed * 1103515245 + 12345;
+                const char *w = words[(seed >> 16) % 14];
+                for (; *w && n < length; w++) {
+                        text[n++] = *w;
+                }
+                if (n < length) {
+                        text[n++] = ' ';
+                }
+        }
+        text[length - 1] = 0;
+
+        clam_scanner_t scanner;
+        static std::uint16_t scanner_table[4096];
+        clam_scanner_init(&scanner, scanner_table, 4096, flags, 4);
+
+        printf("\n# Scanning (64 MiB log)\n\n");
+        printf("| %-40s | %12s | |\n", "benchmark", "throughput");
+        printf("|------------------------------------------|--------------|-|\n");
+        bench_bytes("`clam_match_posix_long_option` per token", length, 3, [&] {
+                std::size_t found = 0;
+                for (std::size_t i = 0; i < length - 1; i++) {
+                        if (i > 0 && text[i - 1] != ' ' && text[i - 1] != '\n') {
+                                continue;
+                        }
+                        for (const char *flag : flags) {
+                                clam_match_result_t m = clam_match_posix_long_option(text + i, flag + 1);
+                                if (m && (text[i + m] == ' ' || text[i + m] == '=')) {
+                                        found++;
+                                        break;
+                                }
+                        }
+                }
+                return found;
+        });
+        bench_bytes("`clam_scan_next`", length, 3, [&] {
+                std::size_t found = 0, position = 0;
+                clam_scan_match_t match;
+                while (clam_scan_next(&scanner, text, length, &position, &match)) {
+                        found++;
+                }
+                return found;
+        });
+
+        static const char *const mixed[] = {"caf\xc3\xa9 ", "\xe2\x82\xac" "10 ", "\xf0\x9f\x98\x80 ",
+                                            "\xd0\xbf\xd1\x80\xd0\xb8 ", "\xe6\x97\xa5\xe6\x9c\xac "};
+        char *utf8 = new char[length];
+        n = 0;
+        while (n < length) {
+                seed = seed * 1103515245 + 12345;
+                const char *w = mixed[(seed >> 16) % 5];
+                std::size_t l = strlen(w);
+                if (n + l > length) {
+                        break;
+                }
+                memcpy(utf8 + n, w, l);
+                n += l;
+        }
+
+        printf("\n# UTF-8 validation (64 MiB)\n\n");
+        printf("| %-40s | %12s | |\n", "benchmark", "throughput");
+        printf("|------------------------------------------|--------------|-|\n");
+        bench_bytes("`clam_match_utf8_n` (ASCII)", length, 10, [&] {
+                return clam_match_utf8_n(text, length);
+        });
+        bench_bytes("`clam_match_utf8_n` (mixed)", n, 10, [&] {
+                return clam_match_utf8_n(utf8, n);
+        });
+
+        const std::size_t blob = 1 << 20;
+        static const char digits[] = "0123456789abcdef";
+        static const char base64_alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        char *hex = new char[2 * blob + 1], *base64 = new char[blob / 3 * 4 + 5];
+        std::uint8_t *decoded = new std::uint8_t[blob];
+        for (std::size_t i = 0; i < 2 * blob; i++) {
+                seed = seed * 1103515245 + 12345;
+                hex[i] = digits[(seed >> 16) % 16];
+        }
+        hex[2 * blob] = 0;
+        for (std::size_t i = 0; i < blob / 3 * 4; i++) {
+                seed = seed * 1103515245 + 12345;
+                base64[i] = base64_alphabet[(seed >> 16) % 64];
+        }
+        base64[blob / 3 * 4] = 0;
+
+        printf("\n# Blob decoding (1 MiB decoded)\n\n");
+        printf("| %-40s | %12s | |\n", "benchmark", "throughput");
+        printf("|------------------------------------------|--------------|-|\n");
+        bench_bytes("per-character hex loop", 2 * blob, 200, [&] {
+                std::size_t i = 0;
+                while (clam_match_numeric16_char(hex + i) && clam_match_numeric16_char(hex + i + 1)) {
+                        char hi = clam__fold_char(hex[i]), lo = clam__fold_char(hex[i + 1]);
+                        decoded[i / 2] = (hi <= '9' ? hi - '0' : hi - 'a' + 10) << 4 | (lo <= '9' ? lo - '0' : lo - 'a' + 10);
+                        i += 2;
+                }
+                return i;
+        });
+        bench_bytes("`clam_match_hex`", 2 * blob, 200, [&] {
+                std::size_t size;
+                return clam_match_hex(hex, decoded, blob, &size, nullptr);
+        });
+        bench_bytes("`clam_match_base64`", blob / 3 * 4, 200, [&] {
+                std::size_t size;
+                return clam_match_base64(base64, CLAM_BASE64_STANDARD, decoded, blob, &size, nullptr);
+        });
+        delete[] decoded;
+        delete[] base64;
+        delete[] hex;
+
+        // `--features=` style list: identifiers of 4 to 19 characters
+        char *list_value = new char[length];
+        for (std::size_t i = 0; i < length;) {
+                seed = seed * 1103515245 + 12345;
+                std::size_t n = 4 + (seed >> 16) % 16;
+                for (std::size_t k = 0; k < n && i < length; k++) {
+                        list_value[i++] = 'a' + k;
+                }
+                if (i < length) {
+                        list_value[i++] = ',';
+                }
+        }
+
+        printf("\n# Lists (64 MiB value)\n\n");
+        printf("| %-40s | %12s | |\n", "benchmark", "throughput");
+        printf("|------------------------------------------|--------------|-|\n");
+        bench_bytes("per-character split", length, 5, [&] {
+                std::size_t items = 0, total = 0, start = 0;
+                for (std::size_t i = 0; i <= length; i++) {
+                        if (i == length || list_value[i] == ',') {
+                                items++;
+                                total += i - start;
+                                start = i + 1;
+                        }
+                }
+                return items + total;
+        });
+        bench_bytes("`clam_list_next`", length, 5, [&] {
+                std::size_t items = 0, total = 0;
+                clam_list_t list;
+                clam_slice_t item;
+                clam_list_init(&list, list_value, length, ',', '\\');
+                while (clam_list_next(&list, &item)) {
+                        items++;
+                        total += item.len;
+                }
+                return items + total;
+        });
+        bench_bytes("`clam_list_count`", length, 5, [&] {
+                return clam_list_count(list_value, length, ',', '\\');
+        });
+
+        // `--ids=` style list: 1 to 12 digit integers
+        char *numbers = new char[length + 1];
+        std::size_t elements = 0;
+        for (std::size_t i = 0; i < length;) {
+                seed = seed * 1103515245 + 12345;
+                std::size_t n = 1 + (seed >> 16) % 12;
+                for (std::size_t k = 0; k < n && i < length; k++) {
+                        numbers[i++] = '1' + (k + seed) % 9;
+                }
+                elements++;
+                if (i < length) {
+                        numbers[i++] = ',';
+                }
+        }
+        numbers[length] = 0;
+        uint64_t *values = new uint64_t[elements];
+
+        printf("\n# Numeric lists (64 MiB value)\n\n");
+        printf("| %-40s | %12s | |\n", "benchmark", "throughput");
+        printf("|------------------------------------------|--------------|-|\n");
+        bench_bytes("`strtoull` loop", length, 5, [&] {
+                std::size_t count = 0;
+                for (char *p = numbers, *end; *p; p = *end ? end + 1 : end) {
+                        values[count++] = strtoull(p, &end, 10);
+                }
+                return count;
+        });
+        bench_bytes("`clam_list_parse_u64`", length, 5, [&] {
+                return clam_list_parse_u64(numbers, length, ',', values, nullptr, elements);
+        });
+
+        // 512 `-c` overrides, looked up by full path
+        static char override_args[512][32];
+        static const char *override_keys[512];
+        static const char *const sections[] = {"server", "client", "cache", "log"};
+        clam_override_t *override_nodes = new clam_override_t[2048];
+        uint32_t *override_slots = new uint32_t[4096];
+        char *override_arena = new char[16384];
+        clam_overrides_t overrides;
+        clam_overrides_init(&overrides, override_nodes, 2048, override_slots, 4096, override_arena, 16384);
+        for (int i = 0; i < 512; i++) {
+                clam_slice_t key{}, value{};
+                snprintf(override_args[i], sizeof(override_args[i]), "%s.pool%d.size=%d", sections[i % 4], i / 4, i);
+                clam_match_override(override_args[i], &key, &value);
+                override_args[i][key.len] = 0;
+                override_keys[i] = override_args[i];
+                clam_overrides_set(&overrides, key.ptr, key.len, value.ptr, value.len);
+        }
+
+        printf("\n# Configuration overrides (512)\n\n");
+        printf("| %-40s | %15s | |\n", "benchmark", "time");
+        printf("|------------------------------------------|-----------------|-|\n");
+        bench("linear search", override_keys, 512, rounds / 1000, [](const char *arg) -> clam_match_result_t {
+                for (int i = 0; i < 512; i++) {
+                        if (!strcmp(override_keys[i], arg)) {
+                                return i;
+                        }
+                }
+                return 0;
+        });
+        bench("`clam_overrides_find`", override_keys, 512, rounds / 1000, [&](const char *arg) -> clam_match_result_t {
+                return clam_overrides_find(&overrides, arg, strlen(arg));
+        });
+
+        static const char *const invocations[] = {"/bin/ap000", "/usr/bin/ap123", "ap299", "/usr/local/sbin/ap042",
+                                                  "./ap250", "/bin/ap007", "/opt/tools/bin/ap199", "ap100"};
+        printf("\n# Multi-call dispatch (300 applets)\n\n");
+        printf("| %-40s | %15s | |\n", "benchmark", "time");
+        printf("|------------------------------------------|-----------------|-|\n");
+        bench("`strrchr` and linear `strcmp`", invocations, 8, rounds / 10, [](const char *arg) -> clam_match_result_t {
+                const char *slash = strrchr(arg, '/');
+                const char *name = slash ? slash + 1 : arg;
+                for (int i = 0; i < 300; i++) {
+                        if (!strcmp(applet_storage[i].data(), name)) {
+                                return i;
+                        }
+                }
+                return 0;
+        });
+        bench("`schema::match_basename`", invocations, 8, rounds / 10, [](const char *arg) -> clam_match_result_t {
+                auto m = applets.match_basename(arg);
+                return m ? m.id : 0;
+        });
+
+        // A compiler driver command line of 20000 arguments
+        static char driver_storage[20000][24];
+        static const char *driver_argv[20000];
+        static std::uint32_t driver_positionals[20000];
+        std::size_t npositionals = 0;
+        for (int i = 0; i < 20000; i++) {
+                snprintf(driver_storage[i], sizeof(driver_storage[i]), i % 4 ? "--define=NAME%d=1" : "src/file%d.c", i);
+                driver_argv[i] = driver_storage[i];
+        }
+        auto parse_driver = [](clam_record_t *record, std::uint32_t *positionals) {
+                std::size_t n = 0;
+                record->count = 0;
+                for (std::uint32_t a = 0; a < 20000; a++) {
+                        const char *arg = driver_argv[a];
+                        if (auto m = driver_options.match_posix_long_option(arg)) {
+                                std::uint32_t value = m.length + clam_match_char(arg + m.length, '=');
+                                clam_record_add(record, static_cast<std::uint16_t>(m.id), a, value,
+                                                static_cast<std::uint32_t>(strlen(arg + value)), 1);
+                        } else {
+                                positionals[n++] = a;
+                        }
+                }
+                return n;
+        };
+        std::uint32_t *driver_arena = new std::uint32_t[20000 * 4];
+        clam_record_t driver;
+        clam_record_init(&driver, driver_arena, 20000 * 16);
+        npositionals = parse_driver(&driver, driver_positionals);
+        std::size_t snapshot_size = clam_snapshot_write(&driver, driver_argv, driver_positionals, npositionals,
+                                                        driver_options.hash(), nullptr, 0);
+        std::uint64_t *snapshot_data = new std::uint64_t[snapshot_size / 8 + 1];
+        clam_snapshot_write(&driver, driver_argv, driver_positionals, npositionals, driver_options.hash(), snapshot_data,
+                            snapshot_size);
+
+        static const char *const once[] = {""};
+        printf("\n# Snapshots (20000 arguments)\n\n");
+        printf("| %-40s | %15s | |\n", "benchmark", "time");
+        printf("|------------------------------------------|-----------------|-|\n");
+        bench("parsing and recording `argv`", once, 1, 200, [&](const char *) -> clam_match_result_t {
+                return parse_driver(&driver, driver_positionals);
+        });
+        bench("`clam_snapshot_open`", once, 1, 200, [&](const char *) -> clam_match_result_t {
+                clam_snapshot_t snapshot;
+                return clam_snapshot_open(&snapshot, snapshot_data, snapshot_size, driver_options.hash(),
+                                          driver_options.size) == CLAM_ERROR_NONE
+                       ? snapshot.record.count
+                       : 0;
+        });
+
+        clam_parse_step_t driver_step = [](void *, const char *const *argv, std::size_t, std::size_t a,
+                                           clam_record_t *record) -> std::size_t {
+                if (auto m = driver_options.match_posix_long_option(argv[a])) {
+                        std::uint32_t value = m.length + clam_match_char(argv[a] + m.length, '=');
+                        clam_record_add(record, static_cast<std::uint16_t>(m.id), static_cast<std::uint32_t>(a), value,
+                                        static_cast<std::uint32_t>(strlen(argv[a] + value)), 1);
+                }
+                return 1;
+        };
+        static const char *edited_argv[20000];
+        static std::uint32_t spans[20000];
+        memcpy(edited_argv, driver_argv, sizeof(driver_argv));
+        clam_incremental_t incremental;
+        clam_incremental_init(&incremental, driver_step, nullptr, &driver, spans, 20000);
+        clam_incremental_parse(&incremental, edited_argv, 20000);
+        printf("\n# Incremental parsing (20000 arguments, one edited)\n\n");
+        printf("| %-40s | %15s | |\n", "benchmark", "time");
+        printf("|------------------------------------------|-----------------|-|\n");
+        bench("`clam_incremental_parse`", once, 1, 200, [&](const char *) -> clam_match_result_t {
+                edited_argv[10001] = edited_argv[10001] == driver_argv[10001] ? "--define=EDITED=1" : driver_argv[10001];
+                clam_incremental_parse(&incremental, edited_argv, 20000);
+                return incremental.reparsed;
+        });
+        bench("`clam_incremental_update`", once, 1, 200, [&](const char *) -> clam_match_result_t {
+                edited_argv[10001] = edited_argv[10001] == driver_argv[10001] ? "--define=EDITED=1" : driver_argv[10001];
+                clam_incremental_update(&incremental, edited_argv, 20000, 10001, 1, 1);
+                return incremental.reparsed;
+        });
+
+        // The driver command line as received over a socket, in 1460-byte segments
+        char *wire = new char[20000 * 24];
+        std::size_t wire_size = 0;
+        for (int i = 0; i < 20000; i++) {
+                std::size_t n = strlen(driver_argv[i]) + 1;
+                memcpy(wire + wire_size, driver_argv[i], n);
+                wire_size += n;
+        }
+        clam_push_argument_t push_argument = [](void *context, const char *arg, std::size_t, std::size_t index,
+                                                clam_push_kind_t kind) -> std::size_t {
+                auto record = static_cast<clam_record_t *>(context);
+                if (kind == CLAM_PUSH_ARGUMENT) {
+                        if (auto m = driver_options.match_posix_long_option(arg)) {
+                                std::uint32_t value = m.length + clam_match_char(arg + m.length, '=');
+                                clam_record_add(record, static_cast<std::uint16_t>(m.id), static_cast<std::uint32_t>(index),
+                                                value, static_cast<std::uint32_t>(strlen(arg + value)), 1);
+                        }
+                }
+                return 0;
+        };
+        printf("\n# Push parsing (20000 arguments in 1460-byte segments)\n\n");
+        printf("| %-40s | %15s | |\n", "benchmark", "time");
+        printf("|------------------------------------------|-----------------|-|\n");
+        bench("buffering, splitting and parsing", once, 1, 200, [&](const char *) -> clam_match_result_t {
+                static char received[20000 * 24];
+                static const char *received_argv[20000];
+                std::size_t at, argc = 0;
+                for (at = 0; at < wire_size; at += 1460) {
+                        memcpy(received + at, wire + at, wire_size - at < 1460 ? wire_size - at : 1460);
+                }
+                for (at = 0; at < wire_size; at += strlen(received + at) + 1) {
+                        received_argv[argc++] = received + at;
+                }
+                driver.count = 0;
+                for (std::size_t a = 0; a < argc; a++) {
+                        push_argument(&driver, received_argv[a], 0, a, CLAM_PUSH_ARGUMENT);
+                }
+                return driver.count;
+        });
+        bench("`clam_push_feed`", once, 1, 200, [&](const char *) -> clam_match_result_t {
+                char buffer[64];
+                clam_push_t push;
+                clam_push_init(&push, push_argument, &driver, buffer, sizeof(buffer));
+                driver.count = 0;
+                for (std::size_t at = 0; at < wire_size; at += 1460) {
+                        clam_push_feed(&push, wire + at, wire_size - at < 1460 ? wire_size - at : 1460);
+                }
+                clam_push_finish(&push);
+                return driver.count;
+        });
+        delete[] wire;
+        delete[] snapshot_data;
+        delete[] driver_arena;
+        delete[] override_arena;
+        delete[] override_slots;
+        delete[] override_nodes;
+        delete[] values;
+        delete[] numbers;
+        delete[] list_value;
+        delete[] utf8;
+        delete[] text;
+        return 0;
+}
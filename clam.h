@@ -63,6 +63,17 @@
  *
  * CLAM's baseline expectation is C99. It *may* use C11 if supported by the compiler.
  *
+ * ### Does it use SIMD?
+ *
+ * Some matchers use SSE2/SSSE3 when the compiler targets them (for example,
+ * with `-mssse3` or `-march=native`) and fall back to portable C otherwise.
+ * Defining `CLAM_NO_SIMD` before including `clam.h` disables SIMD entirely.
+ *
+ * ### Does it touch the file system?
+ *
+ * Only the parse cache (see \ref cache), which is compiled in when
+ * `CLAM_CACHE` is defined before including `clam.h`.
+ *
  * ### Why a header file library?
  *
  * Ease of distribution.
@@ -122,10 +133,35 @@
 #include <limits.h>
 #include <stdint.h>
 
+#ifdef CLAM_CACHE
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
 #ifdef FRAMA_C_STRING
 #define CLAM_USING_FRAME
 #endif
 
+/// \cond
+#if !defined(CLAM_NO_SIMD) && !defined(__FRAMAC__)
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define CLAM__SSE2
+#endif
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#define CLAM__SSSE3
+#endif
+#endif
+/// \endcond
+
 #ifndef CLAM_API
 /**
  * CLAM API function declaration specifier
@@ -135,6 +171,58 @@
 #define CLAM_API static inline
 #endif
 
+/// \cond
+/*@
+  @ requires x != 0;
+  @ assigns \nothing;
+  @ ensures 0 <= \result < 32;
+  @*/
+CLAM_API int
+         clam__ctz32(
+           uint32_t x
+         )
+{
+#if (defined(__GNUC__) || defined(__clang__)) && !defined(__FRAMAC__)
+         return __builtin_ctz(x);
+#else
+         int n = 0;
+         /*@
+           @ loop assigns x, n;
+           @*/
+         while (!(x & 1)) {
+                 x >>= 1;
+                 n++;
+         }
+         return n;
+#endif
+}
+
+/*@
+  @ requires x != 0;
+  @ assigns \nothing;
+  @ ensures 0 <= \result < 32;
+  @*/
+CLAM_API int
+         clam__clz32(
+           uint32_t x
+         )
+{
+#if (defined(__GNUC__) || defined(__clang__)) && !defined(__FRAMAC__)
+         return __builtin_clz(x);
+#else
+         int n = 0;
+         /*@
+           @ loop assigns x, n;
+           @*/
+         while (!(x & UINT32_C(0x80000000))) {
+                 x <<= 1;
+                 n++;
+         }
+         return n;
+#endif
+}
+/// \endcond
+
 /*@
   @ axiomatic StrlenAxioms {
   @
@@ -191,6 +279,23 @@
  */
 typedef uintptr_t clam_match_result_t;
 
+/**
+ * Errors reported by matchers and other CLAM functions that can fail
+ * for reasons other than input not matching.
+ */
+typedef enum {
+        /** No error */
+        CLAM_ERROR_NONE = 0,
+        /** Malformed input or description */
+        CLAM_ERROR_INVALID,
+        /** Caller-provided storage is too small */
+        CLAM_ERROR_CAPACITY,
+        /** Value does not fit into its type */
+        CLAM_ERROR_RANGE,
+        /** Value is given more than once */
+        CLAM_ERROR_DUPLICATE,
+} clam_error_t;
+
 /**
  * \defgroup character-matchers Basic character matchers
  *
@@ -793,6 +898,67 @@ CLAM_API clam_match_result_t
          return clam_match_chars_to_end(input, clam__dashes);
 }
 
+/**
+ * Matches the directory part of the first `length` characters of `input`:
+ * everything up to and including the last `/`
+ *
+ * The base name (such as the applet name of a multi-call binary's
+ * `argv[0]`) starts at `input + ` the result. The last `/` is found 16
+ * bytes at a time from the end with SSE2.
+ */
+/*@
+  @ requires \valid_read(input + (0 .. length - 1));
+  @ assigns \nothing;
+  @ ensures 0 <= \result <= length;
+  @ ensures \result > 0 ==> input[\result - 1] == '/';
+  @ ensures \forall integer k; \result <= k < length ==> input[k] != '/';
+  @*/
+CLAM_API clam_match_result_t
+         clam_match_dirname_n(
+           const char *input,
+           size_t      length
+         )
+{
+         size_t i = length;
+
+#ifdef CLAM__SSE2
+         const __m128i slash = _mm_set1_epi8('/');
+         while (i >= 16) {
+                 uint32_t found = (uint32_t) _mm_movemask_epi8(
+                   _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *) (input + i - 16)), slash));
+                 if (found) {
+                         return i - 16 + (size_t) (32 - clam__clz32(found));
+                 }
+                 i -= 16;
+         }
+#endif
+         /*@
+           @ loop invariant 0 <= i <= length;
+           @ loop assigns i;
+           @*/
+         while (i > 0 && input[i - 1] != '/') {
+                 i--;
+         }
+         return i;
+}
+
+/**
+ * Matches the directory part of `input`
+ *
+ * \see clam_match_dirname_n
+ */
+/*@
+  @ requires valid_read_string(input);
+  @ assigns \nothing;
+  @*/
+CLAM_API clam_match_result_t
+         clam_match_dirname(
+           const char *input
+         )
+{
+         return clam_match_dirname_n(input, strlen(input));
+}
+
 
 /**@}*/
 
@@ -861,6 +1027,6040 @@ CLAM_API clam_match_result_t
 
 /**@}*/
 
+/**
+ * \defgroup case-insensitive-matchers Case-insensitive matchers
+ *
+ * Matching regardless of ASCII letter case
+ *
+ * These matchers fold ASCII letters only (without consulting the locale), 8
+ * or 16 characters at a time.
+ *
+ * @{
+ */
+
+/*@
+  @ axiomatic CaseFolding {
+  @   logic char fold_char(char x) = is_upper_char(x) ? (char) (x + 32) : x;
+  @ }
+  @*/
+
+/*@
+  @ assigns \nothing;
+  @ ensures \result == fold_char(c);
+  @*/
+CLAM_API char
+         clam__fold_char(
+           char c
+         )
+{
+         return c >= 'A' && c <= 'Z' ? (char) (c + ('a' - 'A')) : c;
+}
+
+/*
+ * Folds eight characters at once: the high bit of every byte is set for
+ * characters in 'A'..'Z' and shifted down to 0x20.
+ */
+/*@
+  @ assigns \nothing;
+  @*/
+CLAM_API uint64_t
+         clam__fold64(
+           uint64_t x
+         )
+{
+         const uint64_t high = UINT64_C(0x8080808080808080);
+         uint64_t seven = x & ~high;
+         uint64_t above_z = seven + UINT64_C(0x0101010101010101) * (0x7f - 'Z');
+         uint64_t from_a = seven + UINT64_C(0x0101010101010101) * (0x80 - 'A');
+         uint64_t upper = (from_a ^ above_z) & ~x & high;
+         return x | upper >> 2;
+}
+
+/*
+ * Compares `n` characters of `a` and `b` (both must have at least `n`
+ * readable characters) regardless of case.
+ */
+/*@
+  @ requires \valid_read(a + (0 .. n - 1));
+  @ requires \valid_read(b + (0 .. n - 1));
+  @ assigns \nothing;
+  @ ensures \result \in (0..1);
+  @ ensures \result == 1 <==> \forall integer k; 0 <= k < n ==> fold_char(a[k]) == fold_char(b[k]);
+  @*/
+CLAM_API int
+         clam__equal_nocase(
+           const char *a,
+           const char *b,
+           size_t      n
+         )
+{
+         size_t i = 0;
+#if defined(CLAM__SSE2)
+         const __m128i offset = _mm_set1_epi8((char) (0x80 - 'A'));
+         const __m128i limit = _mm_set1_epi8((char) (-0x80 + 26));
+         const __m128i bit = _mm_set1_epi8(0x20);
+         for (; i + 16 <= n; i += 16) {
+                 __m128i va = _mm_loadu_si128((const __m128i *) (a + i));
+                 __m128i vb = _mm_loadu_si128((const __m128i *) (b + i));
+                 va = _mm_or_si128(va, _mm_and_si128(_mm_cmplt_epi8(_mm_add_epi8(va, offset), limit), bit));
+                 vb = _mm_or_si128(vb, _mm_and_si128(_mm_cmplt_epi8(_mm_add_epi8(vb, offset), limit), bit));
+                 if (_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)) != 0xffff) {
+                         return 0;
+                 }
+         }
+#endif
+         /*@
+           @ loop assigns i;
+           @*/
+         for (; i + 8 <= n; i += 8) {
+                 uint64_t wa, wb;
+                 memcpy(&wa, a + i, 8);
+                 memcpy(&wb, b + i, 8);
+                 if (clam__fold64(wa) != clam__fold64(wb)) {
+                         return 0;
+                 }
+         }
+         /*@
+           @ loop invariant 0 <= i <= n;
+           @ loop assigns i;
+           @*/
+         for (; i < n; i++) {
+                 if (clam__fold_char(a[i]) != clam__fold_char(b[i])) {
+                         return 0;
+                 }
+         }
+         return 1;
+}
+
+/**
+ * Matches `input` if it matches `chars` regardless of case
+ *
+ * Case-insensitive version of \ref clam_match_chars.
+ */
+/*@
+  @ requires valid_read_string(input);
+  @ requires valid_read_string(chars);
+  @ assigns \nothing;
+  @ ensures \result == 0 || \result == strlen(chars);
+  @ ensures \result <= strlen(input);
+  @ behavior no_chars:
+  @   assumes strlen(chars) == 0 || strlen(input) == 0;
+  @   ensures \result == 0;
+  @ behavior right_size:
+  @   assumes strlen(chars) > 0;
+  @   assumes strlen(input) >= strlen(chars);
+  @   ensures \result == strlen(chars) <==> \forall integer k;
+  @                                          0 <= k < strlen(chars) ==>
+  @                                          fold_char(input[k]) == fold_char(chars[k]);
+  @ behavior too_small:
+  @   assumes strlen(chars) > 0;
+  @   assumes 0 < strlen(input) < strlen(chars);
+  @   ensures \result == 0;
+  @ complete behaviors;
+  @ disjoint behaviors;
+  @*/
+CLAM_API clam_match_result_t
+         clam_match_chars_nocase(
+           const char * restrict input,
+           const char *          chars
+         )
+{
+         size_t n = strlen(chars);
+
+         // memchr stops at the first null character, so it never reads past
+         // the end of a shorter input
+         if (n == 0 || memchr(input, 0, n)) {
+                 return 0;
+         }
+         return clam__equal_nocase(input, chars, n) ? n : 0;
+}
+
+/**
+ * Matches `input` if it matches and terminates with `chars` regardless of
+ * case
+ *
+ * Case-insensitive version of \ref clam_match_chars_to_end.
+ */
+/*@
+  @ requires valid_read_string(input);
+  @ requires valid_read_string(chars);
+  @ assigns \nothing;
+  @ ensures \result == 0 || \result == strlen(chars);
+  @ ensures \result > 0 ==> strlen(input) == strlen(chars);
+  @*/
+CLAM_API clam_match_result_t
+         clam_match_chars_to_end_nocase(
+           const char * restrict input,
+           const char *          chars
+         )
+{
+         clam_match_result_t i = 0;
+
+         if (!(i = clam_match_chars_nocase(input, chars))) {
+                 return 0;
+         }
+
+         return clam_match_end(input + i) ? i : 0;
+}
+
+/**
+ * Matches `input` if it matches a dash (`-`) followed by `option`
+ * regardless of case
+ *
+ * Case-insensitive version of \ref clam_match_posix_long_option.
+ */
+/*@
+  @ requires valid_read_string(input);
+  @ requires valid_read_string(option);
+  @ assigns \nothing;
+  @ ensures \result == 0 || \result == strlen(option) + 1;
+  @ ensures \result > 0 ==> input[0] == '-';
+  @ ensures \result > 1 ==> \forall integer k;
+  @                            0 <= k < strlen(option) ==>
+  @                                fold_char(input[k+1]) == fold_char(option[k]);
+  @*/
+CLAM_API clam_match_result_t
+         clam_match_posix_long_option_nocase(
+           const char * restrict input,
+           const char * restrict option
+         )
+{
+         clam_match_result_t dash = clam_match_char(input, '-');
+         if (dash == 0) {
+                 return 0;
+         }
+         clam_match_result_t opt = clam_match_chars_nocase(input + dash, option);
+         return opt ? dash + opt : 0;
+}
+
+/**
+ * Matches `input` if it matches one of the allowed single-character
+ * Windows-style switches in `allowed_switches` regardless of case
+ *
+ * Case-insensitive version of \ref clam_match_windows_switch.
+ */
+/*@
+  @ requires valid_read_string(input);
+  @ requires allowed_switches == \null || valid_read_string(allowed_switches);
+  @ assigns \nothing;
+  @ ensures \result == 0 || \result == 2;
+  @ ensures \result == 2 ==> input[0] == '/' && is_alphanumeric_char(input[1]);
+  @*/
+CLAM_API clam_match_result_t
+         clam_match_windows_switch_nocase(
+           const char * restrict input,
+           const char *          allowed_switches
+         )
+{
+         if (!clam_match_char(input, '/') || !clam_match_alphanumeric_char(input + 1)) {
+                 return 0;
+         }
+         if (allowed_switches == NULL) {
+                 return 2;
+         }
+         clam_match_result_t i = 0;
+         /*@
+           @ loop invariant 0 <= i <= strlen(allowed_switches);
+           @ loop assigns i;
+           @*/
+         while (!clam_match_end(allowed_switches + i)) {
+                 if (clam__fold_char(allowed_switches[i]) == clam__fold_char(input[1])) {
+                         return 2;
+                 }
+                 i++;
+         }
+         return 0;
+}
+
+/**
+ * Matches `input` if it contains forward slash followed by `switch_s`
+ * regardless of case
+ *
+ * Case-insensitive version of \ref clam_match_windows_long_switch.
+ */
+/*@
+  @ requires valid_read_string(input);
+  @ requires valid_read_string(switch_s);
+  @ assigns \nothing;
+  @ ensures \result == 0 || \result == strlen(switch_s) + 1;
+  @ ensures \result > 0 ==> input[0] == '/';
+  @ ensures \result > 1 ==> \forall integer k;
+  @                            0 <= k < strlen(switch_s) ==>
+  @                                fold_char(input[k+1]) == fold_char(switch_s[k]);
+  @*/
+CLAM_API clam_match_result_t
+         clam_match_windows_long_switch_nocase(
+           const char * restrict input,
+           const char * restrict switch_s
+         )
+{
+         clam_match_result_t slash = clam_match_char(input, '/');
+         if (slash == 0) {
+                 return 0;
+         }
+         clam_match_result_t swtch = clam_match_chars_nocase(input + slash, switch_s);
+         return swtch ? slash + swtch : 0;
+}
+
+/**@}*/
+
+/**
+ * \defgroup value-matchers Value matchers
+ *
+ * Matching (and converting) option values
+ *
+ * @{
+ */
+
+/*
+ * Returns the length of a valid UTF-8 character (Unicode 3.9, table 3-7) at
+ * the beginning of `input` of `length` bytes, or zero if there is none.
+ */
+/*@
+  @ requires length > 0;
+  @ requires \valid_read(input + (0 .. length - 1));
+  @ assigns \nothing;
+  @ ensures 0 <= \result <= 4;
+  @ ensures \result <= length;
+  @*/
+CLAM_API size_t
+         clam__utf8_char(
+           const char *input,
+           size_t      length
+         )
+{
+         const unsigned char *s = (const unsigned char *) input;
+         unsigned char lo = 0x80, hi = 0xbf;
+         size_t n, i;
+
+         if (s[0] < 0x80) {
+                 return 1;
+         } else if (s[0] >= 0xc2 && s[0] <= 0xdf) {
+                 n = 2;
+         } else if (s[0] >= 0xe0 && s[0] <= 0xef) {
+                 n = 3;
+                 lo = s[0] == 0xe0 ? 0xa0 : 0x80;
+                 hi = s[0] == 0xed ? 0x9f : 0xbf;
+         } else if (s[0] >= 0xf0 && s[0] <= 0xf4) {
+                 n = 4;
+                 lo = s[0] == 0xf0 ? 0x90 : 0x80;
+                 hi = s[0] == 0xf4 ? 0x8f : 0xbf;
+         } else {
+                 return 0;
+         }
+         if (length < n || s[1] < lo || s[1] > hi) {
+                 return 0;
+         }
+         /*@
+           @ loop invariant 2 <= i <= n;
+           @ loop assigns i;
+           @*/
+         for (i = 2; i < n; i++) {
+                 if (s[i] < 0x80 || s[i] > 0xbf) {
+                         return 0;
+                 }
+         }
+         return n;
+}
+
+#if defined(CLAM__SSSE3)
+/*
+ * Lookup-table UTF-8 validation (Keiser & Lemire, "Validating UTF-8 In Less
+ * Than One Instruction Per Byte"): every error is identified by the high and
+ * low nibbles of the previous byte and the high nibble of the current one.
+ *
+ * Returns the offset up to which `input` has been validated; a character
+ * might still be incomplete at that offset.
+ */
+CLAM_API size_t
+         clam__utf8_ssse3(
+           const char *input,
+           size_t      length
+         )
+{
+         enum {
+                 TOO_SHORT = 1 << 0, TOO_LONG = 1 << 1, OVERLONG_3 = 1 << 2,
+                 TOO_LARGE = 1 << 3, SURROGATE = 1 << 4, OVERLONG_2 = 1 << 5,
+                 TOO_LARGE_1000 = 1 << 6, OVERLONG_4 = 1 << 6, TWO_CONTS = 1 << 7,
+                 CARRY = TOO_SHORT | TOO_LONG | TWO_CONTS,
+         };
+         const __m128i byte_1_high = _mm_setr_epi8(
+                 TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+                 (char) TWO_CONTS, (char) TWO_CONTS, (char) TWO_CONTS, (char) TWO_CONTS,
+                 TOO_SHORT | OVERLONG_2,
+                 TOO_SHORT,
+                 TOO_SHORT | OVERLONG_3 | SURROGATE,
+                 (char) (TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4));
+         const __m128i byte_1_low = _mm_setr_epi8(
+                 (char) (CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4),
+                 (char) (CARRY | OVERLONG_2),
+                 (char) CARRY,
+                 (char) CARRY,
+                 (char) (CARRY | TOO_LARGE),
+                 (char) (CARRY | TOO_LARGE | TOO_LARGE_1000),
+                 (char) (CARRY | TOO_LARGE | TOO_LARGE_1000),
+                 (char) (CARRY | TOO_LARGE | TOO_LARGE_1000),
+                 (char) (CARRY | TOO_LARGE | TOO_LARGE_1000),
+                 (char) (CARRY | TOO_LARGE | TOO_LARGE_1000),
+                 (char) (CARRY | TOO_LARGE | TOO_LARGE_1000),
+                 (char) (CARRY | TOO_LARGE | TOO_LARGE_1000),
+                 (char) (CARRY | TOO_LARGE | TOO_LARGE_1000),
+                 (char) (CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE),
+                 (char) (CARRY | TOO_LARGE | TOO_LARGE_1000),
+                 (char) (CARRY | TOO_LARGE | TOO_LARGE_1000));
+         const __m128i byte_2_high = _mm_setr_epi8(
+                 TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+                 TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+                 (char) (TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4),
+                 (char) (TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE),
+                 (char) (TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE),
+                 (char) (TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE),
+                 TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT);
+         const __m128i incomplete = _mm_setr_epi8(
+                 -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                 (char) (0xf0 - 1), (char) (0xe0 - 1), (char) (0xc0 - 1));
+         const __m128i nibble = _mm_set1_epi8(15);
+         __m128i prev = _mm_setzero_si128();
+         size_t i = 0;
+
+         while (i + 64 <= length) {
+                 __m128i a = _mm_loadu_si128((const __m128i *) (input + i));
+                 __m128i b = _mm_loadu_si128((const __m128i *) (input + i + 16));
+                 __m128i c = _mm_loadu_si128((const __m128i *) (input + i + 32));
+                 __m128i d = _mm_loadu_si128((const __m128i *) (input + i + 48));
+                 // ASCII-only blocks are valid unless a character is left
+                 // incomplete before them
+                 if (!_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d))) &&
+                     _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_subs_epu8(prev, incomplete),
+                                                      _mm_setzero_si128())) == 0xffff) {
+                         prev = d;
+                         i += 64;
+                         continue;
+                 }
+                 break;
+         }
+         while (i + 16 <= length) {
+                 __m128i v = _mm_loadu_si128((const __m128i *) (input + i));
+                 __m128i prev1 = _mm_alignr_epi8(v, prev, 15);
+                 __m128i prev2 = _mm_alignr_epi8(v, prev, 14);
+                 __m128i prev3 = _mm_alignr_epi8(v, prev, 13);
+                 __m128i special = _mm_and_si128(
+                         _mm_and_si128(
+                                 _mm_shuffle_epi8(byte_1_high, _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble)),
+                                 _mm_shuffle_epi8(byte_1_low, _mm_and_si128(prev1, nibble))),
+                         _mm_shuffle_epi8(byte_2_high, _mm_and_si128(_mm_srli_epi16(v, 4), nibble)));
+                 __m128i must23 = _mm_or_si128(_mm_subs_epu8(prev2, _mm_set1_epi8((char) (0xe0 - 0x80))),
+                                               _mm_subs_epu8(prev3, _mm_set1_epi8((char) (0xf0 - 0x80))));
+                 __m128i error = _mm_xor_si128(_mm_and_si128(must23, _mm_set1_epi8((char) 0x80)), special);
+                 if (_mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128())) != 0xffff) {
+                         break;
+                 }
+                 prev = v;
+                 i += 16;
+         }
+         return i;
+}
+#endif
+
+/**
+ * Matches the longest valid UTF-8 prefix of the first `length` bytes of
+ * `input`
+ *
+ * Only complete characters are matched. Overlong encodings, surrogates and
+ * code points above U+10FFFF are not valid.
+ */
+/*@
+  @ requires \valid_read(input + (0 .. length - 1));
+  @ assigns \nothing;
+  @ ensures \result <= length;
+  @*/
+CLAM_API clam_match_result_t
+         clam_match_utf8_n(
+           const char * restrict input,
+           size_t                length
+         )
+{
+         size_t i = 0;
+
+#if defined(CLAM__SSSE3)
+         i = clam__utf8_ssse3(input, length);
+         // Restart from the beginning of the character that may be incomplete
+         // (or invalid) at `i`
+         {
+                 size_t back = 0;
+                 while (back < 3 && i > back &&
+                        ((unsigned char) input[i - back - 1] & 0xc0) == 0x80) {
+                         back++;
+                 }
+                 if (i > back && (unsigned char) input[i - back - 1] >= 0xc0) {
+                         back++;
+                 }
+                 i -= back;
+         }
+#endif
+         /*@
+           @ loop invariant 0 <= i <= length;
+           @ loop assigns i;
+           @*/
+         while (i < length) {
+                 size_t n;
+                 if ((unsigned char) input[i] >= 0x80) {
+                         if (!(n = clam__utf8_char(input + i, length - i))) {
+                                 break;
+                         }
+                         i += n;
+                         continue;
+                 }
+#if defined(CLAM__SSE2)
+                 while (i + 16 <= length &&
+                        !_mm_movemask_epi8(_mm_loadu_si128((const __m128i *) (input + i)))) {
+                         i += 16;
+                 }
+#endif
+                 /*@
+                   @ loop assigns i;
+                   @*/
+                 while (i + 8 <= length) {
+                         uint64_t word;
+                         memcpy(&word, input + i, 8);
+                         if (word & UINT64_C(0x8080808080808080)) {
+                                 break;
+                         }
+                         i += 8;
+                 }
+                 /*@
+                   @ loop assigns i;
+                   @*/
+                 while (i < length && (unsigned char) input[i] < 0x80) {
+                         i++;
+                 }
+         }
+         return i;
+}
+
+/**
+ * Matches the longest valid UTF-8 prefix of `input`
+ *
+ * \see clam_match_utf8_n
+ */
+/*@
+  @ requires valid_read_string(input);
+  @ assigns \nothing;
+  @ ensures \result <= strlen(input);
+  @*/
+CLAM_API clam_match_result_t
+         clam_match_utf8(
+           const char * restrict input
+         )
+{
+         return clam_match_utf8_n(input, strlen(input));
+}
+
+/// \cond clam_internal
+/*@
+  @ requires error == \null || \valid(error);
+  @ assigns *error;
+  @ ensures \result == 0;
+  @*/
+CLAM_API clam_match_result_t
+         clam__set_error(
+           clam_error_t *error,
+           clam_error_t  code
+         )
+{
+         if (error) {
+                 *error = code;
+         }
+         return 0;
+}
+
+/*
+ * Converts `length` decimal digits into `*value`, returning zero if they
+ * do not fit
+ */
+/*@
+  @ requires \valid_read(input + (0 .. length - 1));
+  @ requires \forall integer k; 0 <= k < length ==> is_numeric10_char(input[k]);
+  @ requires \valid(value);
+  @ assigns *value;
+  @*/
+CLAM_API int
+         clam__decimal(
+           const char * restrict input,
+           size_t                length,
+           uint64_t * restrict   value
+         )
+{
+         uint64_t v = 0;
+         size_t i;
+
+         /*@
+           @ loop invariant 0 <= i <= length;
+           @ loop assigns i, v;
+           @*/
+         for (i = 0; i < length; i++) {
+                 unsigned d = (unsigned) (input[i] - '0');
+                 if (v > (UINT64_MAX - d) / 10) {
+                         return 0;
+                 }
+                 v = v * 10 + d;
+         }
+         *value = v;
+         return 1;
+}
+
+/*
+ * Matches an unsigned decimal number with an optional fraction (`1`, `1.5`),
+ * storing its integer part, up to 18 digits of its fraction and the matching
+ * power of ten (`fraction / scale` is the fractional part)
+ *
+ * If nothing is matched, `*error` is set to `CLAM_ERROR_INVALID` or, if the
+ * integer part does not fit, to `CLAM_ERROR_RANGE`.
+ */
+/*@
+  @ requires valid_read_string(input);
+  @ requires \valid(integer) && \valid(fraction) && \valid(scale);
+  @ requires \valid(error);
+  @ assigns *integer, *fraction, *scale, *error;
+  @ ensures \result <= strlen(input);
+  @*/
+CLAM_API clam_match_result_t
+         clam__match_fixed10(
+           const char * restrict   input,
+           uint64_t * restrict     integer,
+           uint64_t * restrict     fraction,
+           uint64_t * restrict     scale,
+           clam_error_t * restrict error
+         )
+{
+         clam_match_result_t i = clam_match_unsigned_integer10(input), digits, f;
+
+         *integer = *fraction = 0;
+         *scale = 1;
+         if (!i) {
+                 return clam__set_error(error, CLAM_ERROR_INVALID);
+         }
+         if (!clam__decimal(input, i, integer)) {
+                 return clam__set_error(error, CLAM_ERROR_RANGE);
+         }
+         if (input[i] == '.' && (digits = clam_match_unsigned_integer10(input + i + 1))) {
+                 /*@
+                   @ loop invariant 0 <= f <= 18 && f <= digits;
+                   @ loop assigns f, *fraction, *scale;
+                   @*/
+                 for (f = 0; f < digits && f < 18; f++) {
+                         *fraction = *fraction * 10 + (uint64_t) (input[i + 1 + f] - '0');
+                         *scale *= 10;
+                 }
+                 i += 1 + digits;
+         }
+         return i;
+}
+
+/*
+ * Computes `a * b / c` rounded down, for `a < c <= 10^18` and `b < 2^62`
+ */
+/*@
+  @ requires a < c <= 1000000000000000000;
+  @ requires b < 4611686018427387904;
+  @ assigns \nothing;
+  @ ensures \result <= b;
+  @*/
+CLAM_API uint64_t
+         clam__muldiv(
+           uint64_t a,
+           uint64_t b,
+           uint64_t c
+         )
+{
+         uint64_t result = 0, remainder = 0;
+         int bit;
+
+         /*@
+           @ loop invariant -1 <= bit <= 63;
+           @ loop invariant remainder < c;
+           @ loop assigns bit, result, remainder;
+           @*/
+         for (bit = 63; bit >= 0; bit--) {
+                 result <<= 1;
+                 remainder <<= 1;
+                 if ((b >> bit) & 1) {
+                         remainder += a;
+                 }
+                 while (remainder >= c) {
+                         remainder -= c;
+                         result++;
+                 }
+         }
+         return result;
+}
+/// \endcond
+
+/**
+ * Matches a size (`4096`, `64K`, `4MiB`, `1.5GB`) and stores it in `*value`
+ * in bytes
+ *
+ * A size is a decimal number with an optional fraction, followed by an
+ * optional unit: `K`, `M`, `G`, `T`, `P` or `E` (in either case) alone or
+ * followed by `iB` are powers of 1024, followed by `B` they are powers of
+ * 1000. A lone `B` stands for bytes. Fractional bytes are rounded down.
+ *
+ * If `error` is not `NULL`, it is set to `CLAM_ERROR_NONE` on a match,
+ * `CLAM_ERROR_INVALID` if there is no size and `CLAM_ERROR_RANGE` if the
+ * size does not fit into `uint64_t` (in which case nothing is matched).
+ */
+/*@
+  @ requires valid_read_string(input);
+  @ requires \valid(value);
+  @ requires error == \null || \valid(error);
+  @ assigns *value, *error;
+  @ ensures \result <= strlen(input);
+  @*/
+CLAM_API clam_match_result_t
+         clam_match_size(
+           const char * restrict   input,
+           uint64_t * restrict     value,
+           clam_error_t * restrict error
+         )
+{
+         static const char units[] = "kmgtpe";
+         uint64_t integer, fraction, scale, multiplier = 1, bytes;
+         clam_error_t status = CLAM_ERROR_NONE;
+         clam_match_result_t i;
+         const char *unit;
+         char c;
+
+         if (!(i = clam__match_fixed10(input, &integer, &fraction, &scale, &status))) {
+                 return clam__set_error(error, status);
+         }
+         c = clam__fold_char(input[i]);
+         if (c >= 'a' && c <= 'z' && (unit = strchr(units, c)) != NULL) {
+                 int power = (int) (unit - units) + 1, k;
+                 uint64_t base = 1024;
+                 i++;
+                 if (input[i] == 'i' && input[i + 1] == 'B') {
+                         i += 2;
+                 } else if (input[i] == 'B') {
+                         base = 1000;
+                         i++;
+                 }
+                 /*@
+                   @ loop invariant 0 <= k <= power;
+                   @ loop assigns k, multiplier;
+                   @*/
+                 for (k = 0; k < power; k++) {
+                         multiplier *= base;
+                 }
+         } else if (input[i] == 'B') {
+                 i++;
+         }
+         if (integer > UINT64_MAX / multiplier) {
+                 return clam__set_error(error, CLAM_ERROR_RANGE);
+         }
+         bytes = integer * multiplier;
+         if (fraction) {
+                 uint64_t part = clam__muldiv(fraction, multiplier, scale);
+                 if (bytes > UINT64_MAX - part) {
+                         return clam__set_error(error, CLAM_ERROR_RANGE);
+                 }
+                 bytes += part;
+         }
+         *value = bytes;
+         clam__set_error(error, CLAM_ERROR_NONE);
+         return i;
+}
+
+/**
+ * Matches a duration (`250ms`, `1h30m`, `-2.5s`) and stores it in `*value`
+ * in nanoseconds
+ *
+ * A duration is an optionally signed sequence of decimal numbers, each with
+ * an optional fraction and a unit: `ns`, `us` (or `µs`), `ms`, `s`, `m` or
+ * `h`. A lone `0` needs no unit. Fractional nanoseconds are rounded down.
+ *
+ * If `error` is not `NULL`, it is set to `CLAM_ERROR_NONE` on a match,
+ * `CLAM_ERROR_INVALID` if there is no duration and `CLAM_ERROR_RANGE` if the
+ * duration does not fit into `int64_t` (in which case nothing is matched).
+ */
+/*@
+  @ requires valid_read_string(input);
+  @ requires \valid(value);
+  @ requires error == \null || \valid(error);
+  @ assigns *value, *error;
+  @ ensures \result <= strlen(input);
+  @*/
+CLAM_API clam_match_result_t
+         clam_match_duration(
+           const char * restrict   input,
+           int64_t * restrict      value,
+           clam_error_t * restrict error
+         )
+{
+         static const struct {
+                 const char *name;
+                 uint64_t    nanoseconds;
+         } units[] = {
+                 {"ns", 1}, {"us", 1000}, {"\xc2\xb5s", 1000}, {"\xce\xbcs", 1000},
+                 {"ms", 1000000}, {"s", UINT64_C(1000000000)},
+                 {"m", UINT64_C(60000000000)}, {"h", UINT64_C(3600000000000)},
+         };
+         clam_match_result_t sign = clam_match_anychar(input, clam__signs), i = sign, end = 0;
+         uint64_t limit = input[0] == '-' ? (uint64_t) INT64_MAX + 1 : (uint64_t) INT64_MAX;
+         uint64_t total = 0;
+         clam_error_t status;
+
+         /*@
+           @ loop assigns i, end, total, status;
+           @*/
+         for (;;) {
+                 uint64_t integer, fraction, scale, unit = 0, part;
+                 clam_match_result_t n = clam__match_fixed10(input + i, &integer, &fraction, &scale, &status), u = 0;
+                 size_t k;
+
+                 if (!n) {
+                         if (status == CLAM_ERROR_RANGE) {
+                                 return clam__set_error(error, CLAM_ERROR_RANGE);
+                         }
+                         break;
+                 }
+                 /*@
+                   @ loop assigns k, u, unit;
+                   @*/
+                 for (k = 0; k < sizeof(units) / sizeof(units[0]) && !u; k++) {
+                         if ((u = clam_match_chars(input + i + n, units[k].name))) {
+                                 unit = units[k].nanoseconds;
+                         }
+                 }
+                 if (!u) {
+                         // `0` is the only duration without a unit
+                         if (end == 0 && n == 1 && input[i] == '0') {
+                                 end = i + 1;
+                         }
+                         break;
+                 }
+                 if (integer > (limit - total) / unit) {
+                         return clam__set_error(error, CLAM_ERROR_RANGE);
+                 }
+                 part = integer * unit + (fraction ? clam__muldiv(fraction, unit, scale) : 0);
+                 if (part > limit - total) {
+                         return clam__set_error(error, CLAM_ERROR_RANGE);
+                 }
+                 total += part;
+                 i += n + u;
+                 end = i;
+         }
+         if (!end) {
+                 return clam__set_error(error, CLAM_ERROR_INVALID);
+         }
+         *value = input[0] == '-' && total ? -(int64_t) (total - 1) - 1 : (int64_t) total;
+         clam__set_error(error, CLAM_ERROR_NONE);
+         return end;
+}
+
+/// \cond clam_internal
+/*
+ * Loads 8 bytes as a little-endian word, so that `input[k]` is in bits
+ * `8 * k` to `8 * k + 7`
+ */
+/*@
+  @ requires \valid_read(input + (0 .. 7));
+  @ assigns \nothing;
+  @*/
+CLAM_API uint64_t
+         clam__load64le(
+           const char *input
+         )
+{
+         uint64_t word;
+         memcpy(&word, input, 8);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__ && !defined(__FRAMAC__)
+         word = __builtin_bswap64(word);
+#endif
+         return word;
+}
+
+/*
+ * Checks that the bytes of `word` selected by `mask` are decimal digits and
+ * stores their values (with all other bytes cleared) in `*digits`
+ *
+ * Unselected bytes are expected to be checked separately: a byte of 0xca or
+ * above may make this report the next byte as not being a digit.
+ */
+/*@
+  @ requires \valid(digits);
+  @ assigns *digits;
+  @*/
+CLAM_API int
+         clam__swar_digits(
+           uint64_t   word,
+           uint64_t   mask,
+           uint64_t * digits
+         )
+{
+         uint64_t x = word ^ UINT64_C(0x3030303030303030);
+         if ((x | (x + UINT64_C(0x0606060606060606))) & UINT64_C(0xf0f0f0f0f0f0f0f0) & mask) {
+                 return 0;
+         }
+         *digits = x & mask;
+         return 1;
+}
+
+/*
+ * Combines pairs of digit values (as stored by `clam__swar_digits`): byte
+ * `k` of the result is `10 * digits[k] + digits[k + 1]`
+ */
+/*@
+  @ assigns \nothing;
+  @*/
+CLAM_API uint64_t
+         clam__swar_pairs(
+           uint64_t digits
+         )
+{
+         return digits * 10 + (digits >> 8);
+}
+
+/*@
+  @ requires 1 <= month <= 12;
+  @ assigns \nothing;
+  @ ensures 28 <= \result <= 31;
+  @*/
+CLAM_API unsigned
+         clam__days_in_month(
+           unsigned year,
+           unsigned month
+         )
+{
+         static const unsigned char days[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+         if (month == 2 && year % 4 == 0 && (year % 100 != 0 || year % 400 == 0)) {
+                 return 29;
+         }
+         return days[month - 1];
+}
+
+/*
+ * Number of days from 1970-01-01 to the given date of the proleptic
+ * Gregorian calendar (H. Hinnant's `days_from_civil`)
+ */
+/*@
+  @ requires year <= 9999;
+  @ requires 1 <= month <= 12;
+  @ requires 1 <= day <= 31;
+  @ assigns \nothing;
+  @*/
+CLAM_API int64_t
+         clam__days_from_civil(
+           unsigned year,
+           unsigned month,
+           unsigned day
+         )
+{
+         int64_t y = (int64_t) year - (month <= 2);
+         int64_t era = (y >= 0 ? y : y - 399) / 400;
+         int64_t yoe = y - era * 400;
+         int64_t doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+         int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+         return era * 146097 + doe - 719468;
+}
+/// \endcond
+
+/**
+ * Matches an RFC 3339 date and time (`2024-02-29T13:45:00.25+01:00`) and
+ * stores it in `*value` in nanoseconds since the Unix epoch
+ *
+ * The date and time may be separated by `T`, `t` or a space, the seconds may
+ * have a fraction (separated by `.` or `,`, digits past nanoseconds are
+ * matched but ignored) and the offset is either `Z` (`z`) or `+HH:MM`
+ * (`-HH:MM`), optionally without the colon. A leap second (`:60`) is counted
+ * as the first second of the next minute.
+ *
+ * The date and time fields are validated and converted eight characters at
+ * a time.
+ *
+ * If `error` is not `NULL`, it is set to `CLAM_ERROR_NONE` on a match,
+ * `CLAM_ERROR_INVALID` if there is no valid date and time and
+ * `CLAM_ERROR_RANGE` if it can not be represented in `int64_t` nanoseconds
+ * (in which case nothing is matched).
+ */
+/*@
+  @ requires valid_read_string(input);
+  @ requires \valid(value);
+  @ requires error == \null || \valid(error);
+  @ assigns *value, *error;
+  @ ensures \result <= strlen(input);
+  @*/
+CLAM_API clam_match_result_t
+         clam_match_timestamp(
+           const char * restrict   input,
+           int64_t * restrict      value,
+           clam_error_t * restrict error
+         )
+{
+         const int64_t ns = 1000000000;
+         uint64_t date, time, fraction = 0;
+         unsigned year, month, day, hour, minute, second;
+         int64_t seconds, offset = 0;
+         clam_match_result_t i = 19, digits, k;
+
+         // `YYYY-MM-` and `DDTHH:MM`, then `:SS`
+         if (memchr(input, '\0', 19) != NULL ||
+             !clam__swar_digits(clam__load64le(input), UINT64_C(0x00ffff00ffffffff), &date) ||
+             !clam__swar_digits(clam__load64le(input + 8), UINT64_C(0xffff00ffff00ffff), &time) ||
+             input[4] != '-' || input[7] != '-' ||
+             (input[10] != 'T' && input[10] != 't' && input[10] != ' ') ||
+             input[13] != ':' || input[16] != ':' ||
+             !clam_match_numeric10_char(input + 17) || !clam_match_numeric10_char(input + 18)) {
+                 return clam__set_error(error, CLAM_ERROR_INVALID);
+         }
+         date = clam__swar_pairs(date);
+         time = clam__swar_pairs(time);
+         year = (unsigned) (date & 0xff) * 100 + (unsigned) ((date >> 16) & 0xff);
+         month = (unsigned) ((date >> 40) & 0xff);
+         day = (unsigned) (time & 0xff);
+         hour = (unsigned) ((time >> 24) & 0xff);
+         minute = (unsigned) ((time >> 48) & 0xff);
+         second = (unsigned) (input[17] - '0') * 10 + (unsigned) (input[18] - '0');
+         if (month < 1 || month > 12 || day < 1 || day > clam__days_in_month(year, month) ||
+             hour > 23 || minute > 59 || second > 60) {
+                 return clam__set_error(error, CLAM_ERROR_INVALID);
+         }
+
+         if ((input[i] == '.' || input[i] == ',') && (digits = clam_match_unsigned_integer10(input + i + 1))) {
+                 /*@
+                   @ loop invariant 0 <= k <= 9;
+                   @ loop assigns k, fraction;
+                   @*/
+                 for (k = 0; k < 9; k++) {
+                         fraction = fraction * 10 + (k < digits ? (uint64_t) (input[i + 1 + k] - '0') : 0);
+                 }
+                 i += 1 + digits;
+         }
+
+         if (input[i] == 'Z' || input[i] == 'z') {
+                 i++;
+         } else if ((input[i] == '+' || input[i] == '-') &&
+                    clam_match_numeric10_char(input + i + 1) && clam_match_numeric10_char(input + i + 2)) {
+                 clam_match_result_t colon = input[i + 3] == ':';
+                 unsigned hours = (unsigned) (input[i + 1] - '0') * 10 + (unsigned) (input[i + 2] - '0'), minutes;
+                 if (!clam_match_numeric10_char(input + i + 3 + colon) ||
+                     !clam_match_numeric10_char(input + i + 4 + colon)) {
+                         return clam__set_error(error, CLAM_ERROR_INVALID);
+                 }
+                 minutes = (unsigned) (input[i + 3 + colon] - '0') * 10 + (unsigned) (input[i + 4 + colon] - '0');
+                 if (hours > 23 || minutes > 59) {
+                         return clam__set_error(error, CLAM_ERROR_INVALID);
+                 }
+                 offset = ((int64_t) hours * 60 + minutes) * 60 * (input[i] == '-' ? -1 : 1);
+                 i += 5 + colon;
+         } else {
+                 return clam__set_error(error, CLAM_ERROR_INVALID);
+         }
+
+         seconds = clam__days_from_civil(year, month, day) * 86400 +
+                   (int64_t) hour * 3600 + (int64_t) minute * 60 + second - offset;
+         if (seconds > INT64_MAX / ns || (seconds == INT64_MAX / ns && (int64_t) fraction > INT64_MAX % ns) ||
+             seconds < INT64_MIN / ns - 1 || (seconds == INT64_MIN / ns - 1 && (int64_t) fraction < ns + INT64_MIN % ns)) {
+                 return clam__set_error(error, CLAM_ERROR_RANGE);
+         }
+         *value = seconds < 0 ? (seconds + 1) * ns + ((int64_t) fraction - ns) : seconds * ns + (int64_t) fraction;
+         clam__set_error(error, CLAM_ERROR_NONE);
+         return i;
+}
+
+/**
+ * Matches a dotted-quad IPv4 address (`192.168.0.1`) and stores it in
+ * `address` in network byte order
+ *
+ * Each of the four numbers must be between 0 and 255 and have no leading
+ * zeros.
+ */
+/*@
+  @ requires valid_read_string(input);
+  @ requires \valid(address + (0 .. 3));
+  @ assigns address[0 .. 3];
+  @ ensures \result == 0 || 7 <= \result <= 15;
+  @*/
+CLAM_API clam_match_result_t
+         clam_match_ipv4(
+           const char * restrict input,
+           uint8_t * restrict    address
+         )
+{
+         uint8_t octets[4];
+         clam_match_result_t position = 0;
+         unsigned field;
+
+         /*@
+           @ loop invariant 0 <= field <= 4;
+           @ loop invariant position <= 4 * field;
+           @ loop assigns field, position, octets[0 .. 3];
+           @*/
+         for (field = 0; field < 4; field++) {
+                 unsigned value = 0, n = 0;
+                 /*@
+                   @ loop invariant 0 <= n <= 4;
+                   @ loop assigns n, value;
+                   @*/
+                 while (n < 4 && clam_match_numeric10_char(input + position + n)) {
+                         value = value * 10 + (unsigned) (input[position + n] - '0');
+                         n++;
+                 }
+                 if (n == 0 || n > 3 || value > 255 || (n > 1 && input[position] == '0')) {
+                         return 0;
+                 }
+                 octets[field] = (uint8_t) value;
+                 position += n;
+                 if (field < 3) {
+                         if (input[position] != '.') {
+                                 return 0;
+                         }
+                         position++;
+                 }
+         }
+         memcpy(address, octets, 4);
+         return position;
+}
+
+/**
+ * Matches an IPv6 address (`2001:db8::1`, `::ffff:192.168.0.1`) and stores
+ * it in `address` in network byte order
+ *
+ * The address is made of eight groups of one to four hexadecimal digits, of
+ * which the last two may be written as an IPv4 address and a run of at least
+ * one zero group may be replaced by `::`.
+ */
+/*@
+  @ requires valid_read_string(input);
+  @ requires \valid(address + (0 .. 15));
+  @ assigns address[0 .. 15];
+  @ ensures \result <= strlen(input);
+  @*/
+CLAM_API clam_match_result_t
+         clam_match_ipv6(
+           const char * restrict input,
+           uint8_t * restrict    address
+         )
+{
+         uint8_t bytes[16] = {0};
+         clam_match_result_t i = 0;
+         int n = 0, gap = -1;
+
+         if (input[0] == ':' && input[1] == ':') {
+                 gap = 0;
+                 i = 2;
+         }
+         /*@
+           @ loop invariant 0 <= n <= 8;
+           @ loop assigns i, n, gap, bytes[0 .. 15];
+           @*/
+         while (n < 8) {
+                 clam_match_result_t h = 0, v4;
+                 unsigned group = 0;
+                 if (n <= 6 && (v4 = clam_match_ipv4(input + i, bytes + 2 * n))) {
+                         i += v4;
+                         n += 2;
+                         break;
+                 }
+                 /*@
+                   @ loop invariant 0 <= h <= 5;
+                   @ loop assigns h, group;
+                   @*/
+                 while (h < 5 && clam_match_numeric16_char(input + i + h)) {
+                         char c = clam__fold_char(input[i + h]);
+                         group = group * 16 + (unsigned) (c <= '9' ? c - '0' : c - 'a' + 10);
+                         h++;
+                 }
+                 if (h == 0) {
+                         // Only `::` can be followed by nothing
+                         if (gap != n) {
+                                 return 0;
+                         }
+                         break;
+                 }
+                 // A group followed by a dot is an IPv4 address out of place
+                 if (h > 4 || input[i + h] == '.') {
+                         return 0;
+                 }
+                 bytes[2 * n] = (uint8_t) (group >> 8);
+                 bytes[2 * n + 1] = (uint8_t) group;
+                 n++;
+                 i += h;
+                 if (input[i] == ':' && input[i + 1] == ':') {
+                         if (gap >= 0) {
+                                 return 0;
+                         }
+                         gap = n;
+                         i += 2;
+                 } else if (input[i] == ':' && n < 8 && clam_match_numeric16_char(input + i + 1)) {
+                         i++;
+                 } else {
+                         break;
+                 }
+         }
+         if (gap < 0 ? n != 8 : n > 7) {
+                 return 0;
+         }
+         if (gap >= 0) {
+                 int shift = 8 - n, k;
+                 /*@
+                   @ loop assigns k, bytes[0 .. 15];
+                   @*/
+                 for (k = 2 * n - 1; k >= 2 * gap; k--) {
+                         bytes[k + 2 * shift] = bytes[k];
+                         bytes[k] = 0;
+                 }
+         }
+         memcpy(address, bytes, 16);
+         return i;
+}
+
+/// \cond clam_internal
+/*@
+  @ requires valid_read_string(input);
+  @ requires \valid(prefix_length);
+  @ assigns *prefix_length;
+  @ ensures \result <= strlen(input);
+  @*/
+CLAM_API clam_match_result_t
+         clam__match_prefix_length(
+           const char * restrict input,
+           unsigned              max,
+           unsigned * restrict   prefix_length
+         )
+{
+         clam_match_result_t n = input[0] == '/' ? clam_match_unsigned_integer10(input + 1) : 0, k;
+         unsigned value = 0;
+
+         if (n == 0 || n > 3 || (n > 1 && input[1] == '0')) {
+                 return 0;
+         }
+         /*@
+           @ loop invariant 1 <= k <= n + 1;
+           @ loop assigns k, value;
+           @*/
+         for (k = 1; k <= n; k++) {
+                 value = value * 10 + (unsigned) (input[k] - '0');
+         }
+         if (value > max) {
+                 return 0;
+         }
+         *prefix_length = value;
+         return n + 1;
+}
+/// \endcond
+
+/**
+ * Matches an IPv4 network in CIDR notation (`10.0.0.0/8`), storing the
+ * address in `address` and the prefix length (0 to 32) in `*prefix_length`
+ *
+ * Host bits are not required to be zero.
+ */
+/*@
+  @ requires valid_read_string(input);
+  @ requires \valid(address + (0 .. 3));
+  @ requires \valid(prefix_length);
+  @ assigns address[0 .. 3], *prefix_length;
+  @ ensures \result <= strlen(input);
+  @*/
+CLAM_API clam_match_result_t
+         clam_match_ipv4_cidr(
+           const char * restrict input,
+           uint8_t * restrict    address,
+           unsigned * restrict   prefix_length
+         )
+{
+         clam_match_result_t a = clam_match_ipv4(input, address), p;
+         return a && (p = clam__match_prefix_length(input + a, 32, prefix_length)) ? a + p : 0;
+}
+
+/**
+ * Matches an IPv6 network in CIDR notation (`2001:db8::/32`), storing the
+ * address in `address` and the prefix length (0 to 128) in `*prefix_length`
+ *
+ * Host bits are not required to be zero.
+ */
+/*@
+  @ requires valid_read_string(input);
+  @ requires \valid(address + (0 .. 15));
+  @ requires \valid(prefix_length);
+  @ assigns address[0 .. 15], *prefix_length;
+  @ ensures \result <= strlen(input);
+  @*/
+CLAM_API clam_match_result_t
+         clam_match_ipv6_cidr(
+           const char * restrict input,
+           uint8_t * restrict    address,
+           unsigned * restrict   prefix_length
+         )
+{
+         clam_match_result_t a = clam_match_ipv6(input, address), p;
+         return a && (p = clam__match_prefix_length(input + a, 128, prefix_length)) ? a + p : 0;
+}
+
+/// \cond clam_internal
+/*
+ * Decodes 32 hexadecimal digits into 16 bytes, returning a mask with bit
+ * `k` set if `input[k]` is not a hexadecimal digit (in which case `output`
+ * is not meaningful)
+ */
+/*@
+  @ requires \valid_read(input + (0 .. 31));
+  @ requires \valid(output + (0 .. 15));
+  @ assigns output[0 .. 15];
+  @*/
+CLAM_API uint32_t
+         clam__hex_decode32(
+           const char * restrict input,
+           uint8_t * restrict    output
+         )
+{
+#if defined(CLAM__SSE2)
+         uint32_t invalid = 0;
+         __m128i packed[2];
+         int k;
+
+         for (k = 0; k < 2; k++) {
+                 __m128i v = _mm_loadu_si128((const __m128i *) (input + 16 * k));
+                 __m128i digit = _mm_sub_epi8(v, _mm_set1_epi8('0'));
+                 __m128i alpha = _mm_sub_epi8(_mm_or_si128(v, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+                 __m128i is_digit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+                 __m128i is_alpha = _mm_cmpeq_epi8(_mm_min_epu8(alpha, _mm_set1_epi8(5)), alpha);
+                 __m128i nibbles = _mm_or_si128(_mm_and_si128(is_digit, digit),
+                                                _mm_andnot_si128(is_digit, _mm_add_epi8(alpha, _mm_set1_epi8(10))));
+                 invalid |= (uint32_t) (~_mm_movemask_epi8(_mm_or_si128(is_digit, is_alpha)) & 0xffff) << (16 * k);
+                 // Each 16-bit lane holds two nibbles, the first one in its
+                 // lower byte
+                 packed[k] = _mm_or_si128(_mm_and_si128(_mm_slli_epi16(nibbles, 4), _mm_set1_epi16(0x00f0)),
+                                          _mm_srli_epi16(nibbles, 8));
+         }
+         _mm_storeu_si128((__m128i *) output, _mm_packus_epi16(packed[0], packed[1]));
+         return invalid;
+#else
+         uint32_t invalid = 0;
+         int k;
+
+         /*@
+           @ loop invariant 0 <= k <= 32;
+           @ loop assigns k, invalid, output[0 .. 15];
+           @*/
+         for (k = 0; k < 32; k++) {
+                 char c = clam__fold_char(input[k]);
+                 unsigned nibble = c >= '0' && c <= '9' ? (unsigned) (c - '0') :
+                                   c >= 'a' && c <= 'f' ? (unsigned) (c - 'a' + 10) : 16;
+                 if (nibble == 16) {
+                         invalid |= UINT32_C(1) << k;
+                         nibble = 0;
+                 }
+                 output[k / 2] = (uint8_t) (k % 2 ? output[k / 2] | nibble : nibble << 4);
+         }
+         return invalid;
+#endif
+}
+/// \endcond
+
+/**
+ * Matches a UUID and stores its 16 bytes in `uuid`
+ *
+ * Accepts the canonical form (`123e4567-e89b-12d3-a456-426614174000`), the
+ * same in braces (`{123e4567-...}`) and 32 hexadecimal digits without
+ * hyphens, in either case. A UUID followed by another hexadecimal digit is
+ * not matched.
+ */
+/*@
+  @ requires valid_read_string(input);
+  @ requires \valid(uuid + (0 .. 15));
+  @ assigns uuid[0 .. 15];
+  @ ensures \result == 0 || \result == 32 || \result == 36 || \result == 38;
+  @*/
+CLAM_API clam_match_result_t
+         clam_match_uuid(
+           const char * restrict input,
+           uint8_t * restrict    uuid
+         )
+{
+         const char *end = (const char *) memchr(input, '\0', 38);
+         size_t available = end ? (size_t) (end - input) : 38;
+         clam_match_result_t brace = available > 0 && input[0] == '{', length;
+         uint8_t bytes[16];
+         char hex[32];
+         const char *digits = input;
+
+         if (available >= 36 + 2 * brace && input[brace + 8] == '-' && input[brace + 13] == '-' &&
+             input[brace + 18] == '-' && input[brace + 23] == '-') {
+                 memcpy(hex, input + brace, 8);
+                 memcpy(hex + 8, input + brace + 9, 4);
+                 memcpy(hex + 12, input + brace + 14, 4);
+                 memcpy(hex + 16, input + brace + 19, 4);
+                 memcpy(hex + 20, input + brace + 24, 12);
+                 digits = hex;
+                 length = 36;
+                 if (brace && input[37] != '}') {
+                         return 0;
+                 }
+         } else if (!brace && available >= 32) {
+                 length = 32;
+         } else {
+                 return 0;
+         }
+         if (clam__hex_decode32(digits, bytes) || (!brace && clam_match_numeric16_char(input + length))) {
+                 return 0;
+         }
+         memcpy(uuid, bytes, 16);
+         return length + 2 * brace;
+}
+
+/// \cond clam_internal
+#define CLAM__LE8(a, b, c, d, e, f, g, h) \
+        ((uint64_t) (a) | (uint64_t) (b) << 8 | (uint64_t) (c) << 16 | (uint64_t) (d) << 24 | \
+         (uint64_t) (e) << 32 | (uint64_t) (f) << 40 | (uint64_t) (g) << 48 | (uint64_t) (h) << 56)
+/// \endcond
+
+/**
+ * Matches a boolean (`1`, `yes`, `y`, `true`, `t`, `on` and `0`, `no`, `n`,
+ * `false`, `f`, `off`, in any case) and stores it in `*value` as 1 or 0
+ *
+ * The spelling must not be followed by a letter or digit (`onion` is not
+ * matched). Up to eight characters are loaded as a single word, which is
+ * compared against all spellings at once without branching on any of them.
+ */
+/*@
+  @ requires valid_read_string(input);
+  @ requires \valid(value);
+  @ assigns *value;
+  @ ensures \result <= 5;
+  @ ensures \result <= strlen(input);
+  @*/
+CLAM_API clam_match_result_t
+         clam_match_boolean(
+           const char * restrict input,
+           int * restrict        value
+         )
+{
+         static const struct {
+                 uint64_t word;
+                 unsigned length;
+                 int      value;
+         } spellings[] = {
+                 {CLAM__LE8('1', 0, 0, 0, 0, 0, 0, 0), 1, 1},
+                 {CLAM__LE8('y', 0, 0, 0, 0, 0, 0, 0), 1, 1},
+                 {CLAM__LE8('y', 'e', 's', 0, 0, 0, 0, 0), 3, 1},
+                 {CLAM__LE8('t', 0, 0, 0, 0, 0, 0, 0), 1, 1},
+                 {CLAM__LE8('t', 'r', 'u', 'e', 0, 0, 0, 0), 4, 1},
+                 {CLAM__LE8('o', 'n', 0, 0, 0, 0, 0, 0), 2, 1},
+                 {CLAM__LE8('0', 0, 0, 0, 0, 0, 0, 0), 1, 0},
+                 {CLAM__LE8('n', 0, 0, 0, 0, 0, 0, 0), 1, 0},
+                 {CLAM__LE8('n', 'o', 0, 0, 0, 0, 0, 0), 2, 0},
+                 {CLAM__LE8('f', 0, 0, 0, 0, 0, 0, 0), 1, 0},
+                 {CLAM__LE8('f', 'a', 'l', 's', 'e', 0, 0, 0), 5, 0},
+                 {CLAM__LE8('o', 'f', 'f', 0, 0, 0, 0, 0), 3, 0},
+         };
+         const uint64_t ones = UINT64_C(0x0101010101010101), high = UINT64_C(0x8080808080808080);
+         const char *end = (const char *) memchr(input, '\0', 8);
+         char bytes[8] = {0};
+         uint64_t word, seven, digit, letter, alnum;
+         unsigned length = 0, k;
+         int truth = 0;
+
+         // The first 8 characters (the null character and anything past it
+         // are zero), folded, and the high bit of each byte set if it is a
+         // letter or digit
+         memcpy(bytes, input, end ? (size_t) (end - input) : 8);
+         word = clam__fold64(clam__load64le(bytes));
+         seven = word & ~high;
+         digit = (seven + ones * (0x80 - '0')) & ~(seven + ones * (0x7f - '9'));
+         letter = (seven + ones * (0x80 - 'a')) & ~(seven + ones * (0x7f - 'z'));
+         alnum = (digit | letter) & ~word & high;
+         /*@
+           @ loop invariant 0 <= k <= 12;
+           @ loop assigns k, length, truth;
+           @*/
+         for (k = 0; k < sizeof(spellings) / sizeof(spellings[0]); k++) {
+                 unsigned length_k = spellings[k].length;
+                 uint64_t mask = (UINT64_C(1) << (8 * length_k)) - 1;
+                 unsigned match = ((word & mask) == spellings[k].word) & !((alnum >> (8 * length_k + 7)) & 1);
+                 length |= match * length_k;
+                 truth |= (int) match & spellings[k].value;
+         }
+         if (length) {
+                 *value = truth;
+         }
+         return length;
+}
+
+/**
+ * Matches hexadecimal digits in the first `length` bytes of `input` and
+ * decodes them into `output` (of `capacity` bytes), storing the number of
+ * decoded bytes in `*size`
+ *
+ * The match ends at the first character that is not a hexadecimal digit
+ * (or at an unpaired last digit), so the result is also the offset of the
+ * first invalid character. Digits are validated and decoded 32 at a time.
+ * Bytes of `output` past `*size` may be overwritten.
+ *
+ * If `error` is not `NULL`, it is set to `CLAM_ERROR_NONE` on a match,
+ * `CLAM_ERROR_INVALID` if there are no digits and `CLAM_ERROR_CAPACITY` if
+ * `output` is too small (in which case nothing is matched).
+ */
+/*@
+  @ requires \valid_read(input + (0 .. length - 1));
+  @ requires \valid(output + (0 .. capacity - 1));
+  @ requires \valid(size);
+  @ requires error == \null || \valid(error);
+  @ assigns output[0 .. capacity - 1], *size, *error;
+  @ ensures \result <= length;
+  @*/
+CLAM_API clam_match_result_t
+         clam_match_hex_n(
+           const char * restrict   input,
+           size_t                  length,
+           uint8_t * restrict      output,
+           size_t                  capacity,
+           size_t * restrict       size,
+           clam_error_t * restrict error
+         )
+{
+         size_t i = 0, out = 0;
+
+         /*@
+           @ loop invariant i == 2 * out;
+           @ loop assigns i, out, output[0 .. capacity - 1];
+           @*/
+         while (i + 32 <= length && out + 16 <= capacity && !clam__hex_decode32(input + i, output + out)) {
+                 i += 32;
+                 out += 16;
+         }
+         /*@
+           @ loop invariant i == 2 * out;
+           @ loop assigns i, out, output[0 .. capacity - 1];
+           @*/
+         while (i + 2 <= length && clam_match_numeric16_char(input + i) && clam_match_numeric16_char(input + i + 1)) {
+                 char hi = clam__fold_char(input[i]), lo = clam__fold_char(input[i + 1]);
+                 if (out == capacity) {
+                         return clam__set_error(error, CLAM_ERROR_CAPACITY);
+                 }
+                 output[out++] = (uint8_t) ((hi <= '9' ? hi - '0' : hi - 'a' + 10) << 4 |
+                                            (lo <= '9' ? lo - '0' : lo - 'a' + 10));
+                 i += 2;
+         }
+         if (i == 0) {
+                 return clam__set_error(error, CLAM_ERROR_INVALID);
+         }
+         *size = out;
+         clam__set_error(error, CLAM_ERROR_NONE);
+         return i;
+}
+
+/**
+ * Matches hexadecimal digits in `input` and decodes them into `output`
+ *
+ * \see clam_match_hex_n
+ */
+/*@
+  @ requires valid_read_string(input);
+  @ requires \valid(output + (0 .. capacity - 1));
+  @ requires \valid(size);
+  @ requires error == \null || \valid(error);
+  @ assigns output[0 .. capacity - 1], *size, *error;
+  @ ensures \result <= strlen(input);
+  @*/
+CLAM_API clam_match_result_t
+         clam_match_hex(
+           const char * restrict   input,
+           uint8_t * restrict      output,
+           size_t                  capacity,
+           size_t * restrict       size,
+           clam_error_t * restrict error
+         )
+{
+         return clam_match_hex_n(input, strlen(input), output, capacity, size, error);
+}
+
+/**
+ * Base64 alphabets (RFC 4648)
+ */
+typedef enum {
+        /** `A-Z`, `a-z`, `0-9`, `+` and `/` */
+        CLAM_BASE64_STANDARD,
+        /** `A-Z`, `a-z`, `0-9`, `-` and `_` */
+        CLAM_BASE64_URL,
+} clam_base64_alphabet_t;
+
+/// \cond clam_internal
+/*
+ * Returns the value of a base64 character, or 64 if it is not one
+ */
+/*@
+  @ assigns \nothing;
+  @ ensures \result <= 64;
+  @*/
+CLAM_API unsigned
+         clam__base64_value(
+           char c,
+           char c62,
+           char c63
+         )
+{
+         if (c >= 'A' && c <= 'Z') {
+                 return (unsigned) (c - 'A');
+         } else if (c >= 'a' && c <= 'z') {
+                 return (unsigned) (c - 'a' + 26);
+         } else if (c >= '0' && c <= '9') {
+                 return (unsigned) (c - '0' + 52);
+         }
+         return c == c62 ? 62 : c == c63 ? 63 : 64;
+}
+
+#if defined(CLAM__SSE2)
+/*
+ * Decodes 16 base64 characters into 12 bytes, storing 16 bytes; returns
+ * zero (having stored nothing meaningful) if any of them is not valid
+ */
+CLAM_API int
+         clam__base64_decode16(
+           const char * restrict input,
+           uint8_t * restrict    output,
+           char                  c62,
+           char                  c63
+         )
+{
+         __m128i v = _mm_loadu_si128((const __m128i *) input);
+         // Characters above 0x7f are negative and fall outside every range
+         __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('Z' + 1)));
+         __m128i lower = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('z' + 1)));
+         __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1)));
+         __m128i is62 = _mm_cmpeq_epi8(v, _mm_set1_epi8(c62));
+         __m128i is63 = _mm_cmpeq_epi8(v, _mm_set1_epi8(c63));
+         __m128i valid = _mm_or_si128(_mm_or_si128(_mm_or_si128(upper, lower), _mm_or_si128(digit, is62)), is63);
+         __m128i offset, sextets, pairs, words;
+
+         if (_mm_movemask_epi8(valid) != 0xffff) {
+                 return 0;
+         }
+         offset = _mm_or_si128(
+                 _mm_or_si128(_mm_and_si128(upper, _mm_set1_epi8(-'A')),
+                              _mm_and_si128(lower, _mm_set1_epi8(26 - 'a'))),
+                 _mm_or_si128(_mm_and_si128(digit, _mm_set1_epi8(52 - '0')),
+                              _mm_or_si128(_mm_and_si128(is62, _mm_set1_epi8((char) (62 - c62))),
+                                           _mm_and_si128(is63, _mm_set1_epi8((char) (63 - c63))))));
+         sextets = _mm_add_epi8(v, offset);
+         // 12 bits from each pair of sextets, then 24 bits from each pair of
+         // those, most significant first
+         pairs = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(sextets, _mm_set1_epi16(0x00ff)), 6),
+                              _mm_srli_epi16(sextets, 8));
+         words = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+#if defined(CLAM__SSSE3)
+         _mm_storeu_si128((__m128i *) output,
+                          _mm_shuffle_epi8(words, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1)));
+#else
+         {
+                 uint32_t w[4];
+                 int k;
+                 _mm_storeu_si128((__m128i *) w, words);
+                 for (k = 0; k < 4; k++) {
+                         output[3 * k] = (uint8_t) (w[k] >> 16);
+                         output[3 * k + 1] = (uint8_t) (w[k] >> 8);
+                         output[3 * k + 2] = (uint8_t) w[k];
+                 }
+         }
+#endif
+         return 1;
+}
+#endif
+/// \endcond
+
+/**
+ * Matches base64 in the first `length` bytes of `input` (in the given
+ * `alphabet`, with or without `=` padding) and decodes it into `output` (of
+ * `capacity` bytes), storing the number of decoded bytes in `*size`
+ *
+ * The match ends at the first character that can not be decoded (a
+ * character outside of the alphabet, or a last character that does not
+ * complete a byte or has bits past the last byte set), so the result is
+ * also the offset of the first invalid character and every match has a
+ * single encoding. Padding ends the match. Characters are validated and
+ * decoded 16 at a time with SSE2. Bytes of `output` past `*size` may be
+ * overwritten.
+ *
+ * If `error` is not `NULL`, it is set to `CLAM_ERROR_NONE` on a match,
+ * `CLAM_ERROR_INVALID` if nothing can be decoded and `CLAM_ERROR_CAPACITY`
+ * if `output` is too small (in which case nothing is matched).
+ */
+/*@
+  @ requires \valid_read(input + (0 .. length - 1));
+  @ requires \valid(output + (0 .. capacity - 1));
+  @ requires \valid(size);
+  @ requires error == \null || \valid(error);
+  @ assigns output[0 .. capacity - 1], *size, *error;
+  @ ensures \result <= length;
+  @*/
+CLAM_API clam_match_result_t
+         clam_match_base64_n(
+           const char * restrict   input,
+           size_t                  length,
+           clam_base64_alphabet_t  alphabet,
+           uint8_t * restrict      output,
+           size_t                  capacity,
+           size_t * restrict       size,
+           clam_error_t * restrict error
+         )
+{
+         const char c62 = alphabet == CLAM_BASE64_URL ? '-' : '+';
+         const char c63 = alphabet == CLAM_BASE64_URL ? '_' : '/';
+         size_t i = 0, out = 0, n;
+         unsigned values[4];
+
+#if defined(CLAM__SSE2)
+         while (i + 16 <= length && out + 16 <= capacity &&
+                clam__base64_decode16(input + i, output + out, c62, c63)) {
+                 i += 16;
+                 out += 12;
+         }
+#endif
+         /*@
+           @ loop assigns i, out, n, values[0 .. 3], output[0 .. capacity - 1];
+           @*/
+         for (;;) {
+                 /*@
+                   @ loop invariant 0 <= n <= 4;
+                   @ loop assigns n, values[0 .. 3];
+                   @*/
+                 for (n = 0; n < 4 && i + n < length &&
+                             (values[n] = clam__base64_value(input[i + n], c62, c63)) < 64; n++) {
+                 }
+                 // A last character with bits past the last byte set is not
+                 // canonical (RFC 4648, 3.5)
+                 if (n == 3 && values[2] & 0x3) {
+                         n = 2;
+                 }
+                 if (n == 2 && values[1] & 0xf) {
+                         n = 0;
+                 }
+                 if (n < 2) {
+                         break;
+                 }
+                 if (out + n - 1 > capacity) {
+                         return clam__set_error(error, CLAM_ERROR_CAPACITY);
+                 }
+                 output[out++] = (uint8_t) (values[0] << 2 | values[1] >> 4);
+                 if (n > 2) {
+                         output[out++] = (uint8_t) (values[1] << 4 | values[2] >> 2);
+                 }
+                 if (n > 3) {
+                         output[out++] = (uint8_t) (values[2] << 6 | values[3]);
+                 }
+                 i += n;
+                 if (n < 4) {
+                         // The last group, possibly padded
+                         if (i + 4 - n <= length && input[i] == '=' && (n == 3 || input[i + 1] == '=')) {
+                                 i += 4 - n;
+                         }
+                         break;
+                 }
+         }
+         if (i == 0) {
+                 return clam__set_error(error, CLAM_ERROR_INVALID);
+         }
+         *size = out;
+         clam__set_error(error, CLAM_ERROR_NONE);
+         return i;
+}
+
+/**
+ * Matches base64 in `input` and decodes it into `output`
+ *
+ * \see clam_match_base64_n
+ */
+/*@
+  @ requires valid_read_string(input);
+  @ requires \valid(output + (0 .. capacity - 1));
+  @ requires \valid(size);
+  @ requires error == \null || \valid(error);
+  @ assigns output[0 .. capacity - 1], *size, *error;
+  @ ensures \result <= strlen(input);
+  @*/
+CLAM_API clam_match_result_t
+         clam_match_base64(
+           const char * restrict   input,
+           clam_base64_alphabet_t  alphabet,
+           uint8_t * restrict      output,
+           size_t                  capacity,
+           size_t * restrict       size,
+           clam_error_t * restrict error
+         )
+{
+         return clam_match_base64_n(input, strlen(input), alphabet, output, capacity, size, error);
+}
+
+/**@}*/
+
+/**
+ * \defgroup pattern-matchers Runtime patterns
+ *
+ * Matching syntaxes that are only known at runtime
+ *
+ * When a syntax can't be written as a chain of matchers at build time (for
+ * example, when it is defined by a plugin), it can be described at runtime
+ * as a pattern: literals and character classes combined with sequence,
+ * alternation and repetition. Character classes are defined by any of the
+ * single-character matchers (such as \ref clam_match_numeric10_char).
+ *
+ * A pattern is compiled by \ref clam_dfa_compile into a minimized DFA. Its
+ * transition table is indexed by byte class (bytes that the pattern never
+ * distinguishes share a class), and \ref clam_match_dfa walks it in a single
+ * pass over the input.
+ *
+ * \code{.c}
+ * clam_pattern_node_t nodes[8];
+ * clam_pattern_t p;
+ * clam_pattern_init(&p, nodes, 8);
+ * int define = clam_pattern_sequence(&p,
+ *                clam_pattern_literal(&p, "-D"),
+ *                clam_pattern_repeat(&p,
+ *                  clam_pattern_class(&p, clam_match_alphanumeric_char),
+ *                  1, CLAM_PATTERN_UNBOUNDED));
+ *
+ * clam_dfa_t dfa;
+ * uint16_t table[1024];
+ * if (clam_dfa_compile(&dfa, table, 1024, &p, define) != CLAM_ERROR_NONE) {
+ *   // ...
+ * }
+ *
+ * if ((i = clam_match_dfa(arg, &dfa))) {
+ *   // ...
+ * }
+ * \endcode
+ *
+ * @{
+ */
+
+#ifndef CLAM_PATTERN_MAX_NFA_STATES
+/**
+ * Maximum number of intermediate (NFA) states a pattern can expand to
+ *
+ * Determines stack usage of \ref clam_dfa_compile. Can be redefined
+ * externally (must be a multiple of 64).
+ */
+#define CLAM_PATTERN_MAX_NFA_STATES 256
+#endif
+
+#ifndef CLAM_DFA_MAX_STATES
+/**
+ * Maximum number of DFA states (before minimization)
+ *
+ * Determines stack usage of \ref clam_dfa_compile. Can be redefined
+ * externally.
+ */
+#define CLAM_DFA_MAX_STATES 256
+#endif
+
+/**
+ * `max` value of \ref clam_pattern_repeat for unbounded repetition
+ */
+#define CLAM_PATTERN_UNBOUNDED UINT16_MAX
+
+/**
+ * Kind of \ref clam_pattern_node_t
+ */
+typedef enum {
+        CLAM_PATTERN_LITERAL,
+        CLAM_PATTERN_CLASS,
+        CLAM_PATTERN_SEQUENCE,
+        CLAM_PATTERN_ALTERNATION,
+        CLAM_PATTERN_REPEAT,
+} clam_pattern_kind_t;
+
+/**
+ * Pattern node
+ *
+ * Nodes are created by `clam_pattern_XXX` functions and refer to their
+ * children by index.
+ */
+typedef struct {
+        clam_pattern_kind_t kind;
+        /** First child (sequence, alternation, repeat) */
+        int                 left;
+        /** Second child (sequence, alternation) */
+        int                 right;
+        /** Repetition bounds */
+        uint16_t            min, max;
+        /** Literal characters (must remain valid until compiled) */
+        const char         *literal;
+        /** Character class bitmap */
+        uint64_t            set[4];
+} clam_pattern_node_t;
+
+/**
+ * Pattern under construction, stored in caller-provided nodes
+ */
+typedef struct {
+        clam_pattern_node_t *nodes;
+        int                  capacity;
+        int                  count;
+} clam_pattern_t;
+
+/**
+ * Compiled pattern
+ *
+ * `table` holds `states * nclasses` transitions. Transitions are stored
+ * pre-multiplied by `nclasses` (the offset of the target state's row), state
+ * `0` is the dead state and states from `accepting` onwards are accepting.
+ */
+typedef struct {
+        uint8_t   classes[256];
+        uint16_t *table;
+        uint16_t  nclasses;
+        uint16_t  states;
+        uint16_t  start;
+        uint16_t  accepting;
+} clam_dfa_t;
+
+/**
+ * Initializes an empty `pattern` over `capacity` caller-provided `nodes`
+ */
+/*@
+  @ requires \valid(pattern);
+  @ requires capacity >= 0;
+  @ requires \valid(nodes + (0 .. capacity - 1));
+  @ assigns *pattern;
+  @ ensures pattern->count == 0;
+  @*/
+CLAM_API void
+         clam_pattern_init(
+           clam_pattern_t      *pattern,
+           clam_pattern_node_t *nodes,
+           int                  capacity
+         )
+{
+         pattern->nodes = nodes;
+         pattern->capacity = capacity;
+         pattern->count = 0;
+}
+
+/*@
+  @ requires \valid(pattern);
+  @ requires \valid(pattern->nodes + (0 .. pattern->capacity - 1));
+  @ assigns pattern->count, pattern->nodes[pattern->count];
+  @ ensures \result == -1 || \result == \old(pattern->count);
+  @*/
+CLAM_API int
+         clam__pattern_node(
+           clam_pattern_t      *pattern,
+           clam_pattern_kind_t  kind,
+           int                  left,
+           int                  right
+         )
+{
+         if (pattern->count >= pattern->capacity ||
+             (kind >= CLAM_PATTERN_SEQUENCE &&
+              (left >= pattern->count || right >= pattern->count))) {
+                 return -1;
+         }
+         clam_pattern_node_t *node = &pattern->nodes[pattern->count];
+         memset(node, 0, sizeof(*node));
+         node->kind = kind;
+         node->left = left;
+         node->right = right;
+         return pattern->count++;
+}
+
+/**
+ * Adds a node matching literal `chars`
+ *
+ * Returns the index of the node or `-1` if there is no room.
+ */
+/*@
+  @ requires \valid(pattern);
+  @ requires valid_read_string(chars);
+  @ assigns pattern->count, pattern->nodes[pattern->count];
+  @ ensures \result == -1 || \result == \old(pattern->count);
+  @*/
+CLAM_API int
+         clam_pattern_literal(
+           clam_pattern_t *pattern,
+           const char     *chars
+         )
+{
+         int node = clam__pattern_node(pattern, CLAM_PATTERN_LITERAL, 0, 0);
+         if (node >= 0) {
+                 pattern->nodes[node].literal = chars;
+         }
+         return node;
+}
+
+/**
+ * Adds a node matching one character matched by `matcher`
+ *
+ * `matcher` is any single-character matcher, such as \ref
+ * clam_match_alpha_char. Returns the index of the node or `-1` if there is
+ * no room.
+ */
+/*@
+  @ requires \valid(pattern);
+  @ assigns pattern->count, pattern->nodes[pattern->count];
+  @ ensures \result == -1 || \result == \old(pattern->count);
+  @*/
+CLAM_API int
+         clam_pattern_class(
+           clam_pattern_t      *pattern,
+           clam_match_result_t (*matcher)(const char *)
+         )
+{
+         int node = clam__pattern_node(pattern, CLAM_PATTERN_CLASS, 0, 0);
+         if (node >= 0) {
+                 char c[2] = {0, 0};
+                 int b;
+                 /*@
+                   @ loop invariant 1 <= b <= 256;
+                   @ loop assigns b, c[0], pattern->nodes[node].set[0 .. 3];
+                   @*/
+                 for (b = 1; b < 256; b++) {
+                         c[0] = (char) b;
+                         if (matcher(c) == 1) {
+                                 pattern->nodes[node].set[b >> 6] |= (uint64_t) 1 << (b & 63);
+                         }
+                 }
+         }
+         return node;
+}
+
+/**
+ * Adds a node matching one character out of `chars`
+ *
+ * Follows \ref clam_match_anychar: if `chars` is `NULL`, any character is
+ * matched. Returns the index of the node or `-1` if there is no room.
+ */
+/*@
+  @ requires \valid(pattern);
+  @ requires chars == \null || valid_read_string(chars);
+  @ assigns pattern->count, pattern->nodes[pattern->count];
+  @ ensures \result == -1 || \result == \old(pattern->count);
+  @*/
+CLAM_API int
+         clam_pattern_anychar(
+           clam_pattern_t *pattern,
+           const char     *chars
+         )
+{
+         int node = clam__pattern_node(pattern, CLAM_PATTERN_CLASS, 0, 0);
+         if (node >= 0) {
+                 char c[2] = {0, 0};
+                 int b;
+                 /*@
+                   @ loop invariant 1 <= b <= 256;
+                   @ loop assigns b, c[0], pattern->nodes[node].set[0 .. 3];
+                   @*/
+                 for (b = 1; b < 256; b++) {
+                         c[0] = (char) b;
+                         if (clam_match_anychar(c, chars)) {
+                                 pattern->nodes[node].set[b >> 6] |= (uint64_t) 1 << (b & 63);
+                         }
+                 }
+         }
+         return node;
+}
+
+/**
+ * Adds a node matching node `first` followed by node `second`
+ *
+ * Returns the index of the node or `-1` if there is no room or either
+ * node is invalid.
+ */
+/*@
+  @ requires \valid(pattern);
+  @ assigns pattern->count, pattern->nodes[pattern->count];
+  @ ensures \result == -1 || \result == \old(pattern->count);
+  @*/
+CLAM_API int
+         clam_pattern_sequence(
+           clam_pattern_t *pattern,
+           int             first,
+           int             second
+         )
+{
+         return first < 0 || second < 0 ? -1 :
+                clam__pattern_node(pattern, CLAM_PATTERN_SEQUENCE, first, second);
+}
+
+/**
+ * Adds a node matching either node `first` or node `second`
+ *
+ * Unlike a chain of matchers, alternation is not ordered: the longest match
+ * wins. Returns the index of the node or `-1` if there is no room or either
+ * node is invalid.
+ */
+/*@
+  @ requires \valid(pattern);
+  @ assigns pattern->count, pattern->nodes[pattern->count];
+  @ ensures \result == -1 || \result == \old(pattern->count);
+  @*/
+CLAM_API int
+         clam_pattern_alternation(
+           clam_pattern_t *pattern,
+           int             first,
+           int             second
+         )
+{
+         return first < 0 || second < 0 ? -1 :
+                clam__pattern_node(pattern, CLAM_PATTERN_ALTERNATION, first, second);
+}
+
+/**
+ * Adds a node matching node `repeated` from `min` to `max` times
+ *
+ * `max` can be \ref CLAM_PATTERN_UNBOUNDED. Returns the index of the node or
+ * `-1` if there is no room, the node is invalid or `min > max`.
+ */
+/*@
+  @ requires \valid(pattern);
+  @ assigns pattern->count, pattern->nodes[pattern->count];
+  @ ensures \result == -1 || \result == \old(pattern->count);
+  @*/
+CLAM_API int
+         clam_pattern_repeat(
+           clam_pattern_t *pattern,
+           int             repeated,
+           uint16_t        min,
+           uint16_t        max
+         )
+{
+         if (repeated < 0 || min > max) {
+                 return -1;
+         }
+         int node = clam__pattern_node(pattern, CLAM_PATTERN_REPEAT, repeated, 0);
+         if (node >= 0) {
+                 pattern->nodes[node].min = min;
+                 pattern->nodes[node].max = max;
+         }
+         return node;
+}
+
+/// \cond
+#define CLAM__NFA_WORDS (CLAM_PATTERN_MAX_NFA_STATES / 64)
+
+typedef struct {
+        uint64_t set[4];
+        int16_t  out;
+        int16_t  out1;
+        uint8_t  epsilon;
+} clam__nfa_state_t;
+
+typedef struct {
+        clam__nfa_state_t states[CLAM_PATTERN_MAX_NFA_STATES];
+        int               count;
+} clam__nfa_t;
+/// \endcond
+
+/*@
+  @ requires \valid(nfa);
+  @ assigns nfa->count, nfa->states[nfa->count];
+  @*/
+CLAM_API int
+         clam__nfa_state(
+           clam__nfa_t *nfa,
+           uint8_t      epsilon
+         )
+{
+         if (nfa->count >= CLAM_PATTERN_MAX_NFA_STATES) {
+                 return -1;
+         }
+         clam__nfa_state_t *state = &nfa->states[nfa->count];
+         memset(state, 0, sizeof(*state));
+         state->out = -1;
+         state->out1 = -1;
+         state->epsilon = epsilon;
+         return nfa->count++;
+}
+
+/*
+ * Thompson construction: every fragment starts at `*start` and ends with an
+ * epsilon state `*end` whose `out` is left unconnected.
+ */
+/*@
+  @ requires \valid(nfa);
+  @ requires \valid_read(pattern);
+  @ requires \valid(start) && \valid(end);
+  @ assigns nfa->count, nfa->states[..], *start, *end;
+  @*/
+CLAM_API clam_error_t
+         clam__nfa_build(
+           clam__nfa_t          *nfa,
+           const clam_pattern_t *pattern,
+           int                   index,
+           int                  *start,
+           int                  *end
+         )
+{
+         if (index < 0 || index >= pattern->count) {
+                 return CLAM_ERROR_INVALID;
+         }
+         const clam_pattern_node_t *node = &pattern->nodes[index];
+         int s, e, cur, i;
+         clam_error_t error;
+
+         switch (node->kind) {
+         case CLAM_PATTERN_LITERAL:
+         case CLAM_PATTERN_CLASS:
+                 if ((e = clam__nfa_state(nfa, 1)) < 0) {
+                         return CLAM_ERROR_CAPACITY;
+                 }
+                 if (node->kind == CLAM_PATTERN_LITERAL) {
+                         cur = e;
+                         for (i = (int) strlen(node->literal) - 1; i >= 0; i--) {
+                                 unsigned char c = (unsigned char) node->literal[i];
+                                 if ((s = clam__nfa_state(nfa, 0)) < 0) {
+                                         return CLAM_ERROR_CAPACITY;
+                                 }
+                                 nfa->states[s].set[c >> 6] |= (uint64_t) 1 << (c & 63);
+                                 nfa->states[s].out = (int16_t) cur;
+                                 cur = s;
+                         }
+                         *start = cur;
+                 } else {
+                         if ((s = clam__nfa_state(nfa, 0)) < 0) {
+                                 return CLAM_ERROR_CAPACITY;
+                         }
+                         memcpy(nfa->states[s].set, node->set, sizeof(node->set));
+                         nfa->states[s].out = (int16_t) e;
+                         *start = s;
+                 }
+                 *end = e;
+                 return CLAM_ERROR_NONE;
+
+         case CLAM_PATTERN_SEQUENCE:
+         case CLAM_PATTERN_ALTERNATION: {
+                 int ls, le, rs, re;
+                 if (node->left >= index || node->right >= index) {
+                         return CLAM_ERROR_INVALID;
+                 }
+                 if ((error = clam__nfa_build(nfa, pattern, node->left, &ls, &le)) ||
+                     (error = clam__nfa_build(nfa, pattern, node->right, &rs, &re))) {
+                         return error;
+                 }
+                 if (node->kind == CLAM_PATTERN_SEQUENCE) {
+                         nfa->states[le].out = (int16_t) rs;
+                         *start = ls;
+                         *end = re;
+                         return CLAM_ERROR_NONE;
+                 }
+                 if ((s = clam__nfa_state(nfa, 1)) < 0 || (e = clam__nfa_state(nfa, 1)) < 0) {
+                         return CLAM_ERROR_CAPACITY;
+                 }
+                 nfa->states[s].out = (int16_t) ls;
+                 nfa->states[s].out1 = (int16_t) rs;
+                 nfa->states[le].out = (int16_t) e;
+                 nfa->states[re].out = (int16_t) e;
+                 *start = s;
+                 *end = e;
+                 return CLAM_ERROR_NONE;
+         }
+
+         case CLAM_PATTERN_REPEAT: {
+                 int cs, ce;
+                 if (node->left >= index || node->min > node->max) {
+                         return CLAM_ERROR_INVALID;
+                 }
+                 if ((s = clam__nfa_state(nfa, 1)) < 0 || (e = clam__nfa_state(nfa, 1)) < 0) {
+                         return CLAM_ERROR_CAPACITY;
+                 }
+                 cur = s;
+                 for (i = 0; i < node->min; i++) {
+                         if ((error = clam__nfa_build(nfa, pattern, node->left, &cs, &ce))) {
+                                 return error;
+                         }
+                         nfa->states[cur].out = (int16_t) cs;
+                         cur = ce;
+                 }
+                 if (node->max == CLAM_PATTERN_UNBOUNDED) {
+                         int loop;
+                         if ((loop = clam__nfa_state(nfa, 1)) < 0) {
+                                 return CLAM_ERROR_CAPACITY;
+                         }
+                         if ((error = clam__nfa_build(nfa, pattern, node->left, &cs, &ce))) {
+                                 return error;
+                         }
+                         nfa->states[cur].out = (int16_t) loop;
+                         nfa->states[loop].out = (int16_t) cs;
+                         nfa->states[loop].out1 = (int16_t) e;
+                         nfa->states[ce].out = (int16_t) loop;
+                 } else {
+                         for (i = node->min; i < node->max; i++) {
+                                 int split;
+                                 if ((split = clam__nfa_state(nfa, 1)) < 0) {
+                                         return CLAM_ERROR_CAPACITY;
+                                 }
+                                 if ((error = clam__nfa_build(nfa, pattern, node->left, &cs, &ce))) {
+                                         return error;
+                                 }
+                                 nfa->states[cur].out = (int16_t) split;
+                                 nfa->states[split].out = (int16_t) cs;
+                                 nfa->states[split].out1 = (int16_t) e;
+                                 cur = ce;
+                         }
+                         nfa->states[cur].out = (int16_t) e;
+                 }
+                 *start = s;
+                 *end = e;
+                 return CLAM_ERROR_NONE;
+         }
+         }
+         return CLAM_ERROR_INVALID;
+}
+
+/*@
+  @ requires \valid_read(nfa);
+  @ requires \valid(set + (0 .. CLAM__NFA_WORDS - 1));
+  @ assigns set[0 .. CLAM__NFA_WORDS - 1];
+  @*/
+CLAM_API void
+         clam__nfa_closure(
+           const clam__nfa_t *nfa,
+           uint64_t          *set
+         )
+{
+         int16_t stack[CLAM_PATTERN_MAX_NFA_STATES];
+         int top = 0, i;
+
+         for (i = 0; i < nfa->count; i++) {
+                 if (set[i >> 6] >> (i & 63) & 1) {
+                         stack[top++] = (int16_t) i;
+                 }
+         }
+         while (top > 0) {
+                 const clam__nfa_state_t *state = &nfa->states[stack[--top]];
+                 int16_t outs[2] = {state->out, state->out1};
+                 if (!state->epsilon) {
+                         continue;
+                 }
+                 for (i = 0; i < 2; i++) {
+                         if (outs[i] >= 0 && !(set[outs[i] >> 6] >> (outs[i] & 63) & 1)) {
+                                 set[outs[i] >> 6] |= (uint64_t) 1 << (outs[i] & 63);
+                                 stack[top++] = outs[i];
+                         }
+                 }
+         }
+}
+
+/**
+ * Compiles node `root` of `pattern` into `dfa`
+ *
+ * The transition table is stored in caller-provided `table` of `table_size`
+ * entries. It must have room for the DFA before minimization;
+ * `dfa->states * dfa->nclasses` entries are used after compilation.
+ *
+ * Returns \ref CLAM_ERROR_INVALID if the pattern is malformed and \ref
+ * CLAM_ERROR_CAPACITY if the table (or \ref CLAM_PATTERN_MAX_NFA_STATES or
+ * \ref CLAM_DFA_MAX_STATES) is too small.
+ */
+/*@
+  @ requires \valid(dfa);
+  @ requires \valid(table + (0 .. table_size - 1));
+  @ requires \valid_read(pattern);
+  @ assigns *dfa, table[0 .. table_size - 1];
+  @*/
+CLAM_API clam_error_t
+         clam_dfa_compile(
+           clam_dfa_t           *dfa,
+           uint16_t             *table,
+           size_t                table_size,
+           const clam_pattern_t *pattern,
+           int                   root
+         )
+{
+         clam__nfa_t nfa;
+         uint64_t sets[CLAM_DFA_MAX_STATES][CLAM__NFA_WORDS];
+         uint16_t part[CLAM_DFA_MAX_STATES], next[CLAM_DFA_MAX_STATES];
+         uint16_t rep[CLAM_DFA_MAX_STATES], perm[CLAM_DFA_MAX_STATES];
+         uint8_t accepting[CLAM_DFA_MAX_STATES];
+         uint8_t representative[256];
+         int start, end, b, c, i, j, s, count, k, parts;
+         clam_error_t error;
+
+         nfa.count = 0;
+         if ((error = clam__nfa_build(&nfa, pattern, root, &start, &end))) {
+                 return error;
+         }
+
+         // Byte classes: bytes are equivalent if every NFA state either
+         // accepts both of them or neither of them.
+         {
+                 uint64_t signatures[256][CLAM__NFA_WORDS];
+                 memset(signatures, 0, sizeof(signatures));
+                 for (i = 0; i < nfa.count; i++) {
+                         if (nfa.states[i].epsilon) {
+                                 continue;
+                         }
+                         for (b = 0; b < 256; b++) {
+                                 if (nfa.states[i].set[b >> 6] >> (b & 63) & 1) {
+                                         signatures[b][i >> 6] |= (uint64_t) 1 << (i & 63);
+                                 }
+                         }
+                 }
+                 k = 0;
+                 for (b = 0; b < 256; b++) {
+                         for (c = 0; c < k; c++) {
+                                 if (!memcmp(signatures[b], signatures[representative[c]],
+                                             sizeof(signatures[b]))) {
+                                         break;
+                                 }
+                         }
+                         if (c == k) {
+                                 representative[k++] = (uint8_t) b;
+                         }
+                         dfa->classes[b] = (uint8_t) c;
+                 }
+         }
+
+         // Subset construction; state 0 is the dead (empty) state
+         memset(sets, 0, sizeof(sets[0]) * 2);
+         sets[1][start >> 6] |= (uint64_t) 1 << (start & 63);
+         clam__nfa_closure(&nfa, sets[1]);
+         count = 2;
+         if (table_size < (size_t) count * k) {
+                 return CLAM_ERROR_CAPACITY;
+         }
+         for (c = 0; c < k; c++) {
+                 table[c] = 0;
+         }
+         for (s = 1; s < count; s++) {
+                 for (c = 0; c < k; c++) {
+                         uint64_t target[CLAM__NFA_WORDS];
+                         b = representative[c];
+                         memset(target, 0, sizeof(target));
+                         for (i = 0; i < nfa.count; i++) {
+                                 const clam__nfa_state_t *state = &nfa.states[i];
+                                 if ((sets[s][i >> 6] >> (i & 63) & 1) && !state->epsilon &&
+                                     (state->set[b >> 6] >> (b & 63) & 1)) {
+                                         target[state->out >> 6] |= (uint64_t) 1 << (state->out & 63);
+                                 }
+                         }
+                         clam__nfa_closure(&nfa, target);
+                         for (j = 0; j < count; j++) {
+                                 if (!memcmp(sets[j], target, sizeof(target))) {
+                                         break;
+                                 }
+                         }
+                         if (j == count) {
+                                 if (count == CLAM_DFA_MAX_STATES ||
+                                     table_size < (size_t) (count + 1) * k) {
+                                         return CLAM_ERROR_CAPACITY;
+                                 }
+                                 memcpy(sets[count++], target, sizeof(target));
+                         }
+                         table[s * k + c] = (uint16_t) j;
+                 }
+         }
+
+         // Moore minimization: refine {non-accepting, accepting} until stable
+         parts = 0;
+         for (s = 0; s < count; s++) {
+                 accepting[s] = sets[s][end >> 6] >> (end & 63) & 1;
+                 part[s] = accepting[s];
+                 parts |= 1 << accepting[s];
+         }
+         parts = (parts & 1) + (parts >> 1);
+         for (;;) {
+                 int refined = 0;
+                 for (s = 0; s < count; s++) {
+                         for (i = 0; i < refined; i++) {
+                                 int r = rep[i];
+                                 if (part[r] != part[s]) {
+                                         continue;
+                                 }
+                                 for (c = 0; c < k; c++) {
+                                         if (part[table[r * k + c]] != part[table[s * k + c]]) {
+                                                 break;
+                                         }
+                                 }
+                                 if (c == k) {
+                                         break;
+                                 }
+                         }
+                         if (i == refined) {
+                                 rep[refined++] = (uint16_t) s;
+                         }
+                         next[s] = (uint16_t) i;
+                 }
+                 memcpy(part, next, sizeof(part[0]) * count);
+                 if (refined == parts) {
+                         break;
+                 }
+                 parts = refined;
+         }
+
+         // Renumber partitions: dead state first, accepting states last
+         {
+                 uint16_t id[CLAM_DFA_MAX_STATES];
+                 uint16_t row[256];
+                 uint8_t placed[CLAM_DFA_MAX_STATES];
+                 int n = 0, pass;
+
+                 if ((size_t) parts * k > UINT16_MAX) {
+                         return CLAM_ERROR_CAPACITY;
+                 }
+                 for (pass = 0; pass < 3; pass++) {
+                         for (i = 0; i < parts; i++) {
+                                 int p = part[rep[i]];
+                                 if ((pass == 0) == (p == part[0]) &&
+                                     (pass == 0 || accepting[rep[i]] == pass - 1)) {
+                                         id[p] = (uint16_t) n;
+                                         perm[n++] = rep[i];
+                                 }
+                         }
+                 }
+                 dfa->accepting = (uint16_t) parts;
+                 for (i = 0; i < parts; i++) {
+                         if (accepting[perm[i]]) {
+                                 dfa->accepting = (uint16_t) i;
+                                 break;
+                         }
+                 }
+
+                 // Every row becomes a row of a representative, permuted in place
+                 for (s = 0; s < count; s++) {
+                         for (c = 0; c < k; c++) {
+                                 table[s * k + c] = (uint16_t) (id[part[table[s * k + c]]] * k);
+                         }
+                 }
+                 memset(placed, 0, sizeof(placed));
+                 for (s = 0; s < count; s++) {
+                         if (rep[part[s]] != s) {
+                                 perm[n++] = (uint16_t) s;
+                         }
+                 }
+                 for (s = 0; s < count; s++) {
+                         if (placed[s] || perm[s] == s) {
+                                 continue;
+                         }
+                         // Follow the cycle: row j receives row perm[j]
+                         memcpy(row, &table[s * k], sizeof(row[0]) * k);
+                         j = s;
+                         while (perm[j] != s) {
+                                 memcpy(&table[j * k], &table[perm[j] * k], sizeof(row[0]) * k);
+                                 placed[j] = 1;
+                                 j = perm[j];
+                         }
+                         memcpy(&table[j * k], row, sizeof(row[0]) * k);
+                         placed[j] = 1;
+                 }
+
+                 dfa->start = (uint16_t) (id[part[1]] * k);
+                 dfa->accepting = (uint16_t) (dfa->accepting * k);
+         }
+
+         dfa->table = table;
+         dfa->nclasses = (uint16_t) k;
+         dfa->states = (uint16_t) parts;
+         return CLAM_ERROR_NONE;
+}
+
+/**
+ * Matches `input` against compiled pattern `dfa`
+ *
+ * Returns the length of the longest match.
+ */
+/*@
+  @ requires valid_read_string(input);
+  @ requires \valid_read(dfa);
+  @ assigns \nothing;
+  @ ensures \result <= strlen(input);
+  @*/
+CLAM_API clam_match_result_t
+         clam_match_dfa(
+           const char       * restrict input,
+           const clam_dfa_t *          dfa
+         )
+{
+         const uint16_t *table = dfa->table;
+         const uint8_t *classes = dfa->classes;
+         uint16_t accepting = dfa->accepting;
+         uint32_t state = dfa->start;
+         clam_match_result_t i = 0, matched = 0;
+
+         /*@
+           @ loop invariant 0 <= i <= strlen(input);
+           @ loop invariant 0 <= matched <= i;
+           @ loop assigns i, state, matched;
+           @*/
+         while (!clam_match_end(input + i)) {
+                 state = table[state + classes[(unsigned char) input[i]]];
+                 if (state == 0) {
+                         break;
+                 }
+                 i++;
+                 matched = state >= accepting ? i : matched;
+         }
+         return matched;
+}
+
+/**@}*/
+
+/**@}*/
+
+/**
+ * \defgroup scanning Scanning
+ *
+ * Finding options in large amounts of text
+ *
+ * Scanning looks for a set of option names (such as deprecated or dangerous
+ * flags) in text that is not split into arguments, such as build logs or
+ * shell histories.
+ *
+ * An occurrence must start at a token boundary (the beginning of the text or
+ * after whitespace, a quote or a null character) and end at one (the end of
+ * the text, whitespace, a quote, a null character or `=`). When several
+ * names match at the same position, the longest one is reported.
+ *
+ * \code{.c}
+ * const char *flags[] = {"--no-verify", "-Werror", "--force"};
+ * clam_scanner_t scanner;
+ * uint16_t table[4096];
+ * clam_scanner_init(&scanner, table, 4096, flags, 3);
+ *
+ * size_t position = 0;
+ * clam_scan_match_t match;
+ * while (clam_scan_next(&scanner, text, length, &position, &match)) {
+ *   printf("%s at %zu\n", flags[match.pattern], match.offset);
+ * }
+ * \endcode
+ *
+ * Candidate positions are found with SIMD (with SSSE3, a Teddy-style
+ * fingerprint of the names' first three bytes; with SSE2, token starts
+ * beginning with one of the names' first bytes) and verified by walking a
+ * trie of the names.
+ *
+ * @{
+ */
+
+/**
+ * Set of names to scan for, see \ref clam_scanner_init
+ *
+ * The trie is stored in caller-provided `table`: a row of `nclasses` entries
+ * per node. Entry `0` of a row is the index of the name ending at this node
+ * plus one (zero if none), the other entries are offsets of the child rows
+ * by byte class (zero if none).
+ */
+typedef struct {
+        uint8_t         classes[256];
+        const uint16_t *table;
+        uint16_t        nclasses;
+        uint16_t        nodes;
+        uint8_t         teddy[3][2][16];
+        /** Distinct first bytes of the names (if there are at most four) */
+        uint8_t         first[4];
+        uint8_t         nfirst;
+} clam_scanner_t;
+
+/**
+ * Occurrence found by \ref clam_scan_next
+ */
+typedef struct {
+        /** Index of the name */
+        size_t pattern;
+        /** Offset of the occurrence in the text */
+        size_t offset;
+        /** Length of the occurrence */
+        size_t length;
+} clam_scan_match_t;
+
+/*@
+  @ assigns \nothing;
+  @*/
+CLAM_API int
+         clam__is_token_delimiter(
+           char c
+         )
+{
+         return c == ' ' || (c >= '\t' && c <= '\r') || c == '"' || c == '\'' || c == 0;
+}
+
+/**
+ * Prepares `scanner` to look for `count` names in `patterns`
+ *
+ * The trie is stored in caller-provided `table` of `table_size` entries.
+ *
+ * Returns \ref CLAM_ERROR_INVALID if a name is empty and \ref
+ * CLAM_ERROR_CAPACITY if the table is too small or there are more than
+ * 65534 names (`UINT16_MAX - 1`, as the trie stores name indices in 16
+ * bits).
+ */
+/*@
+  @ requires \valid(scanner);
+  @ requires \valid(table + (0 .. table_size - 1));
+  @ requires \valid_read(patterns + (0 .. count - 1));
+  @ requires \forall integer i; 0 <= i < count ==> valid_read_string(patterns[i]);
+  @ assigns *scanner, table[0 .. table_size - 1];
+  @*/
+CLAM_API clam_error_t
+         clam_scanner_init(
+           clam_scanner_t    *scanner,
+           uint16_t          *table,
+           size_t             table_size,
+           const char *const *patterns,
+           size_t             count
+         )
+{
+         size_t i, j, k = 1, rows = 1;
+         int b;
+
+         memset(scanner, 0, sizeof(*scanner));
+         if (count >= UINT16_MAX) {
+                 return CLAM_ERROR_CAPACITY;
+         }
+         for (i = 0; i < count; i++) {
+                 if (clam_match_end(patterns[i])) {
+                         return CLAM_ERROR_INVALID;
+                 }
+                 for (j = 0; !clam_match_end(patterns[i] + j); j++) {
+                         scanner->classes[(unsigned char) patterns[i][j]] = 1;
+                 }
+         }
+         for (b = 0; b < 256; b++) {
+                 if (scanner->classes[b]) {
+                         scanner->classes[b] = (uint8_t) k++;
+                 }
+         }
+         if (table_size < k) {
+                 return CLAM_ERROR_CAPACITY;
+         }
+         memset(table, 0, sizeof(table[0]) * k);
+
+         for (i = 0; i < count; i++) {
+                 const char *pattern = patterns[i];
+                 size_t node = 0;
+                 uint8_t bucket = (uint8_t) (1u << ((unsigned char) pattern[0] ^
+                                                    (unsigned char) pattern[1] * 3u) % 8);
+
+                 for (j = 0; !clam_match_end(pattern + j); j++) {
+                         uint8_t c = scanner->classes[(unsigned char) pattern[j]];
+                         if (!table[node + c]) {
+                                 if ((rows + 1) * k > table_size || (rows + 1) * k > UINT16_MAX) {
+                                         return CLAM_ERROR_CAPACITY;
+                                 }
+                                 memset(&table[rows * k], 0, sizeof(table[0]) * k);
+                                 table[node + c] = (uint16_t) (rows++ * k);
+                         }
+                         node = table[node + c];
+                 }
+                 if (!table[node]) {
+                         table[node] = (uint16_t) (i + 1);
+                 }
+
+                 for (j = 0; j < scanner->nfirst && j < 4; j++) {
+                         if (scanner->first[j] == (uint8_t) pattern[0]) {
+                                 break;
+                         }
+                 }
+                 if (j == scanner->nfirst) {
+                         if (j < 4) {
+                                 scanner->first[j] = (uint8_t) pattern[0];
+                         }
+                         scanner->nfirst++;
+                 }
+
+                 for (j = 0; j < 3; j++) {
+                         if (j < strlen(pattern)) {
+                                 unsigned char c = (unsigned char) pattern[j];
+                                 scanner->teddy[j][0][c & 15] |= bucket;
+                                 scanner->teddy[j][1][c >> 4] |= bucket;
+                         } else {
+                                 for (b = 0; b < 16; b++) {
+                                         scanner->teddy[j][0][b] |= bucket;
+                                         scanner->teddy[j][1][b] |= bucket;
+                                 }
+                         }
+                 }
+         }
+
+         scanner->table = table;
+         scanner->nclasses = (uint16_t) k;
+         scanner->nodes = (uint16_t) rows;
+         return CLAM_ERROR_NONE;
+}
+
+/*
+ * Walks the trie from `offset`, looking for the longest name that ends at a
+ * token boundary.
+ */
+/*@
+  @ requires \valid_read(scanner);
+  @ requires \valid_read(text + (0 .. length - 1));
+  @ requires offset < length;
+  @ requires \valid(match);
+  @ assigns *match;
+  @*/
+CLAM_API int
+         clam__scan_verify(
+           const clam_scanner_t *scanner,
+           const char           *text,
+           size_t                length,
+           size_t                offset,
+           clam_scan_match_t    *match
+         )
+{
+         const uint16_t *table = scanner->table;
+         size_t node = 0, i = offset;
+         int found = 0;
+
+         /*@
+           @ loop invariant offset <= i <= length;
+           @ loop assigns i, node, found, *match;
+           @*/
+         while (i < length) {
+                 uint8_t c = scanner->classes[(unsigned char) text[i]];
+                 if (!c || !(node = table[node + c])) {
+                         break;
+                 }
+                 i++;
+                 if (table[node] &&
+                     (i == length || clam__is_token_delimiter(text[i]) || text[i] == '=')) {
+                         match->pattern = table[node] - 1u;
+                         match->offset = offset;
+                         match->length = i - offset;
+                         found = 1;
+                 }
+         }
+         return found;
+}
+
+#if defined(CLAM__SSE2)
+/*
+ * Returns a mask of positions in the 16 bytes at `text` that may start an
+ * occurrence. Reads `text[-1]` to `text[17]`.
+ */
+CLAM_API uint32_t
+         clam__scan_candidates(
+           const clam_scanner_t *scanner,
+           const char           *text
+         )
+{
+         __m128i prev = _mm_loadu_si128((const __m128i *) (text - 1));
+         __m128i cur = _mm_loadu_si128((const __m128i *) text);
+         __m128i ws = _mm_sub_epi8(prev, _mm_set1_epi8('\t'));
+         __m128i delimiter = _mm_or_si128(
+                 _mm_or_si128(_mm_cmpeq_epi8(_mm_min_epu8(ws, _mm_set1_epi8(4)), ws),
+                              _mm_cmpeq_epi8(prev, _mm_set1_epi8(' '))),
+                 _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(prev, _mm_set1_epi8('"')),
+                                           _mm_cmpeq_epi8(prev, _mm_set1_epi8('\''))),
+                              _mm_cmpeq_epi8(prev, _mm_setzero_si128())));
+#if defined(CLAM__SSSE3)
+         __m128i nibble = _mm_set1_epi8(15);
+         __m128i buckets = _mm_set1_epi8(-1);
+         int p;
+         for (p = 0; p < 3; p++) {
+                 __m128i v = p == 0 ? cur : _mm_loadu_si128((const __m128i *) (text + p));
+                 __m128i lo = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) scanner->teddy[p][0]),
+                                               _mm_and_si128(v, nibble));
+                 __m128i hi = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) scanner->teddy[p][1]),
+                                               _mm_and_si128(_mm_srli_epi16(v, 4), nibble));
+                 buckets = _mm_and_si128(buckets, _mm_and_si128(lo, hi));
+         }
+         __m128i candidates = _mm_andnot_si128(_mm_cmpeq_epi8(buckets, _mm_setzero_si128()),
+                                               delimiter);
+#else
+         __m128i candidates = _mm_andnot_si128(_mm_cmpeq_epi8(cur, _mm_set1_epi8(' ')), delimiter);
+         if (scanner->nfirst <= 4) {
+                 __m128i first = _mm_setzero_si128();
+                 int j;
+                 for (j = 0; j < scanner->nfirst; j++) {
+                         first = _mm_or_si128(first, _mm_cmpeq_epi8(cur, _mm_set1_epi8((char) scanner->first[j])));
+                 }
+                 candidates = _mm_and_si128(candidates, first);
+         }
+#endif
+         return (uint32_t) _mm_movemask_epi8(candidates);
+}
+#endif
+
+/**
+ * Finds the next occurrence of a name in `text` of `length` bytes, starting at
+ * `*position`
+ *
+ * On success, stores the occurrence in `match`, advances `*position` past it
+ * and returns `1`. Returns `0` when there are no more occurrences.
+ */
+/*@
+  @ requires \valid_read(scanner);
+  @ requires \valid_read(text + (0 .. length - 1));
+  @ requires \valid(position) && \valid(match);
+  @ assigns *position, *match;
+  @ ensures \result \in (0..1);
+  @*/
+CLAM_API int
+         clam_scan_next(
+           const clam_scanner_t *scanner,
+           const char           *text,
+           size_t                length,
+           size_t               *position,
+           clam_scan_match_t    *match
+         )
+{
+         size_t i = *position;
+
+         if (i == 0 && length > 0 && clam__scan_verify(scanner, text, length, 0, match)) {
+                 *position = match->length;
+                 return 1;
+         }
+         i += i == 0;
+#if defined(CLAM__SSE2)
+         while (i + 18 <= length) {
+                 uint32_t candidates = clam__scan_candidates(scanner, text + i);
+                 while (candidates) {
+                         size_t at = i + clam__ctz32(candidates);
+                         candidates &= candidates - 1;
+                         if (clam__scan_verify(scanner, text, length, at, match)) {
+                                 *position = at + match->length;
+                                 return 1;
+                         }
+                 }
+                 i += 16;
+         }
+#endif
+         /*@
+           @ loop assigns i, *match;
+           @*/
+         for (; i < length; i++) {
+                 if (clam__is_token_delimiter(text[i - 1]) &&
+                     clam__scan_verify(scanner, text, length, i, match)) {
+                         *position = i + match->length;
+                         return 1;
+                 }
+         }
+         *position = length;
+         return 0;
+}
+
+/**@}*/
+
+/**
+ * \defgroup lists Lists
+ *
+ * Splitting list values (`--features=a,b,c`) into elements
+ *
+ * Lists are split without copying or modifying the value: each element is
+ * a slice of it, including any escape characters. An empty value has no
+ * elements; otherwise, there is one more element than there are (unescaped)
+ * delimiters, so `a,,b` and `a,` have empty elements.
+ *
+ * \code{.c}
+ * clam_list_t list;
+ * clam_slice_t item;
+ * clam_list_init(&list, value, strlen(value), ',', '\\');
+ * while (clam_list_next(&list, &item)) {
+ *   printf("%.*s\n", (int) item.len, item.ptr);
+ * }
+ * \endcode
+ *
+ * Delimiters and escape characters are found 16 bytes at a time with SSE2.
+ *
+ * @{
+ */
+
+/**
+ * Part of a larger string
+ */
+typedef struct {
+        const char *ptr;
+        size_t      len;
+} clam_slice_t;
+
+/**
+ * List being split, see \ref clam_list_init
+ */
+typedef struct {
+        const char *input;
+        size_t      length;
+        /** Offset of the next element, past `length` when there is none */
+        size_t      position;
+        char        delimiter;
+        /** Character escaping the next one, or `\0` if none */
+        char        escape;
+} clam_list_t;
+
+/// \cond clam_internal
+/*@
+  @ assigns \nothing;
+  @ ensures \result <= 32;
+  @*/
+CLAM_API int
+         clam__popcount32(
+           uint32_t x
+         )
+{
+#if (defined(__GNUC__) || defined(__clang__)) && !defined(__FRAMAC__)
+         return __builtin_popcount(x);
+#else
+         int n = 0;
+         /*@
+           @ loop assigns x, n;
+           @*/
+         while (x) {
+                 x &= x - 1;
+                 n++;
+         }
+         return n;
+#endif
+}
+
+/*
+ * Returns the offset of the first `a` or `b` in `input` at or after `i`, or
+ * `length` if there is none
+ */
+/*@
+  @ requires i <= length;
+  @ requires \valid_read(input + (0 .. length - 1));
+  @ assigns \nothing;
+  @ ensures i <= \result <= length;
+  @*/
+CLAM_API size_t
+         clam__find2(
+           const char *input,
+           size_t      length,
+           size_t      i,
+           char        a,
+           char        b
+         )
+{
+#if defined(CLAM__SSE2)
+         const __m128i va = _mm_set1_epi8(a), vb = _mm_set1_epi8(b);
+         while (i + 16 <= length) {
+                 __m128i v = _mm_loadu_si128((const __m128i *) (input + i));
+                 uint32_t found = (uint32_t) _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, va), _mm_cmpeq_epi8(v, vb)));
+                 if (found) {
+                         return i + (size_t) clam__ctz32(found);
+                 }
+                 i += 16;
+         }
+#endif
+         /*@
+           @ loop invariant i <= length;
+           @ loop assigns i;
+           @*/
+         while (i < length && input[i] != a && input[i] != b) {
+                 i++;
+         }
+         return i;
+}
+/// \endcond
+
+/**
+ * Starts splitting the first `length` bytes of `input` into elements
+ * separated by `delimiter`
+ *
+ * If `escape` is not `\0`, it makes the character following it part of the
+ * element even if it is the delimiter.
+ */
+/*@
+  @ requires \valid(list);
+  @ requires \valid_read(input + (0 .. length - 1));
+  @ assigns *list;
+  @*/
+CLAM_API void
+         clam_list_init(
+           clam_list_t *list,
+           const char  *input,
+           size_t       length,
+           char         delimiter,
+           char         escape
+         )
+{
+         list->input = input;
+         list->length = length;
+         list->position = length == 0 ? 1 : 0;
+         list->delimiter = delimiter;
+         list->escape = escape;
+}
+
+/**
+ * Stores the next element of `list` in `*item`
+ *
+ * Returns zero if there are no more elements.
+ */
+/*@
+  @ requires \valid(list);
+  @ requires \valid(item);
+  @ assigns list->position, *item;
+  @*/
+CLAM_API int
+         clam_list_next(
+           clam_list_t  *list,
+           clam_slice_t *item
+         )
+{
+         size_t start = list->position, i = start;
+         char escape = list->escape ? list->escape : list->delimiter;
+
+         if (start > list->length) {
+                 return 0;
+         }
+         /*@
+           @ loop assigns i;
+           @*/
+         for (;;) {
+                 i = clam__find2(list->input, list->length, i, list->delimiter, escape);
+                 if (i == list->length || list->input[i] == list->delimiter) {
+                         break;
+                 }
+                 i = i + 2 < list->length ? i + 2 : list->length;
+         }
+         item->ptr = list->input + start;
+         item->len = i - start;
+         list->position = i + 1;
+         return 1;
+}
+
+/**
+ * Returns the number of elements \ref clam_list_next would split the first
+ * `length` bytes of `input` into
+ *
+ * Blocks of 16 bytes without escape characters are counted with SSE2.
+ */
+/*@
+  @ requires \valid_read(input + (0 .. length - 1));
+  @ assigns \nothing;
+  @*/
+CLAM_API size_t
+         clam_list_count(
+           const char *input,
+           size_t      length,
+           char        delimiter,
+           char        escape
+         )
+{
+         size_t count = 1, i = 0;
+         int escaped = 0;
+
+         if (length == 0) {
+                 return 0;
+         }
+         /*@
+           @ loop invariant i <= length;
+           @ loop assigns i, count, escaped;
+           @*/
+         while (i < length) {
+#if defined(CLAM__SSE2)
+                 if (!escaped && i + 16 <= length) {
+                         __m128i v = _mm_loadu_si128((const __m128i *) (input + i));
+                         if (!escape || !_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8(escape)))) {
+                                 count += (size_t) clam__popcount32(
+                                         (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8(delimiter))));
+                                 i += 16;
+                                 continue;
+                         }
+                 }
+#endif
+                 if (escaped) {
+                         escaped = 0;
+                 } else if (escape && input[i] == escape) {
+                         escaped = 1;
+                 } else if (input[i] == delimiter) {
+                         count++;
+                 }
+                 i++;
+         }
+         return count;
+}
+
+/**
+ * Copies `item` to `output` (of at least `item.len` bytes) without escape
+ * characters, returning the length of the copy
+ */
+/*@
+  @ requires \valid_read(item.ptr + (0 .. item.len - 1));
+  @ requires \valid(output + (0 .. item.len - 1));
+  @ assigns output[0 .. item.len - 1];
+  @ ensures \result <= item.len;
+  @*/
+CLAM_API size_t
+         clam_slice_unescape(
+           clam_slice_t item,
+           char         escape,
+           char        *output
+         )
+{
+         size_t i, n = 0;
+
+         /*@
+           @ loop invariant n <= i <= item.len + 1;
+           @ loop assigns i, n, output[0 .. item.len - 1];
+           @*/
+         for (i = 0; i < item.len; i++) {
+                 if (escape && item.ptr[i] == escape && i + 1 < item.len) {
+                         i++;
+                 }
+                 output[n++] = item.ptr[i];
+         }
+         return n;
+}
+
+/// \cond clam_internal
+/*
+ * Converts `length` characters at `input` (of which `available` can be read)
+ * as an unsigned decimal number, eight digits at a time
+ */
+/*@
+  @ requires length <= available;
+  @ requires \valid_read(input + (0 .. available - 1));
+  @ requires \valid(value);
+  @ assigns *value;
+  @*/
+CLAM_API clam_error_t
+         clam__parse_u64(
+           const char *input,
+           size_t      length,
+           size_t      available,
+           uint64_t   *value
+         )
+{
+         static const uint64_t powers[9] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000};
+         uint64_t result = 0;
+         size_t i = 0;
+
+         if (length == 0) {
+                 return CLAM_ERROR_INVALID;
+         }
+         /*@
+           @ loop invariant i <= length;
+           @ loop assigns i, result;
+           @*/
+         while (i < length) {
+                 // The first chunk takes the digits that do not make a full
+                 // one, so that all others have eight
+                 size_t n = (length - i) % 8 ? (length - i) % 8 : 8, k;
+                 uint64_t word = 0, digits, scale = powers[n];
+                 if (i + 8 <= available) {
+                         word = clam__load64le(input + i);
+                 } else {
+                         /*@
+                           @ loop assigns k, word;
+                           @*/
+                         for (k = 0; k < n; k++) {
+                                 word |= (uint64_t) (unsigned char) input[i + k] << (8 * k);
+                         }
+                 }
+                 if (!clam__swar_digits(word, n == 8 ? UINT64_MAX : (UINT64_C(1) << (8 * n)) - 1, &digits)) {
+                         return CLAM_ERROR_INVALID;
+                 }
+                 // Right-align the digits, leaving leading zeros
+                 digits <<= 8 * (8 - n);
+                 digits = (digits * 10 + (digits >> 8)) & UINT64_C(0x00ff00ff00ff00ff);
+                 digits = (digits * 100 + (digits >> 16)) & UINT64_C(0x0000ffff0000ffff);
+                 digits = (digits * 10000 + (digits >> 32)) & UINT64_C(0x00000000ffffffff);
+                 if (result > (UINT64_MAX - digits) / scale) {
+                         return CLAM_ERROR_RANGE;
+                 }
+                 result = result * scale + digits;
+                 i += n;
+         }
+         *value = result;
+         return CLAM_ERROR_NONE;
+}
+
+typedef enum {
+        CLAM__LIST_U32,
+        CLAM__LIST_U64,
+        CLAM__LIST_I64,
+} clam__list_type_t;
+
+/*@
+  @ requires \valid_read(input + (0 .. length - 1));
+  @ requires errors == \null || \valid(errors + (0 .. capacity - 1));
+  @*/
+CLAM_API size_t
+         clam__list_parse(
+           const char        *input,
+           size_t             length,
+           char               delimiter,
+           void              *values,
+           clam__list_type_t  type,
+           clam_error_t      *errors,
+           size_t             capacity
+         )
+{
+         size_t count = 0, start = 0, end;
+
+         if (length == 0) {
+                 return 0;
+         }
+         /*@
+           @ loop assigns count, start, end;
+           @*/
+         for (;;) {
+                 end = clam__find2(input, length, start, delimiter, delimiter);
+                 if (count < capacity) {
+                         uint64_t magnitude = 0;
+                         size_t sign = type == CLAM__LIST_I64 && end > start &&
+                                       (input[start] == '-' || input[start] == '+');
+                         int negative = sign && input[start] == '-';
+                         clam_error_t status = clam__parse_u64(input + start + sign, end - start - sign,
+                                                               length - start - sign, &magnitude);
+                         if (status == CLAM_ERROR_NONE &&
+                             ((type == CLAM__LIST_U32 && magnitude > UINT32_MAX) ||
+                              (type == CLAM__LIST_I64 && magnitude > (uint64_t) INT64_MAX + negative))) {
+                                 status = CLAM_ERROR_RANGE;
+                         }
+                         if (status != CLAM_ERROR_NONE) {
+                                 magnitude = 0;
+                         }
+                         switch (type) {
+                         case CLAM__LIST_U32:
+                                 ((uint32_t *) values)[count] = (uint32_t) magnitude;
+                                 break;
+                         case CLAM__LIST_U64:
+                                 ((uint64_t *) values)[count] = magnitude;
+                                 break;
+                         case CLAM__LIST_I64:
+                                 ((int64_t *) values)[count] = negative && magnitude ? -(int64_t) (magnitude - 1) - 1
+                                                                                     : (int64_t) magnitude;
+                                 break;
+                         }
+                         if (errors) {
+                                 errors[count] = status;
+                         }
+                 }
+                 count++;
+                 if (end == length) {
+                         return count;
+                 }
+                 start = end + 1;
+         }
+}
+/// \endcond
+
+/**
+ * Converts the elements of a list of unsigned decimal numbers (the first
+ * `length` bytes of `input`, separated by `delimiter`) into `values`
+ *
+ * Returns the number of elements in the list, of which only the first
+ * `capacity` are converted (\ref clam_list_count gives the number upfront).
+ * If `errors` is not `NULL`, `errors[k]` is set to `CLAM_ERROR_NONE`,
+ * `CLAM_ERROR_INVALID` (the element is not a number) or `CLAM_ERROR_RANGE`
+ * (it does not fit) for each converted element; `values[k]` is zero for
+ * elements that are not converted successfully.
+ *
+ * Delimiters are found with SSE2 and digits are validated and converted
+ * eight at a time.
+ */
+/*@
+  @ requires \valid_read(input + (0 .. length - 1));
+  @ requires \valid(values + (0 .. capacity - 1));
+  @ requires errors == \null || \valid(errors + (0 .. capacity - 1));
+  @ assigns values[0 .. capacity - 1], errors[0 .. capacity - 1];
+  @*/
+CLAM_API size_t
+         clam_list_parse_u64(
+           const char   *input,
+           size_t        length,
+           char          delimiter,
+           uint64_t     *values,
+           clam_error_t *errors,
+           size_t        capacity
+         )
+{
+         return clam__list_parse(input, length, delimiter, values, CLAM__LIST_U64, errors, capacity);
+}
+
+/**
+ * Converts the elements of a list of unsigned decimal numbers into `values`
+ *
+ * \see clam_list_parse_u64
+ */
+/*@
+  @ requires \valid_read(input + (0 .. length - 1));
+  @ requires \valid(values + (0 .. capacity - 1));
+  @ requires errors == \null || \valid(errors + (0 .. capacity - 1));
+  @ assigns values[0 .. capacity - 1], errors[0 .. capacity - 1];
+  @*/
+CLAM_API size_t
+         clam_list_parse_u32(
+           const char   *input,
+           size_t        length,
+           char          delimiter,
+           uint32_t     *values,
+           clam_error_t *errors,
+           size_t        capacity
+         )
+{
+         return clam__list_parse(input, length, delimiter, values, CLAM__LIST_U32, errors, capacity);
+}
+
+/**
+ * Converts the elements of a list of signed decimal numbers (with optional
+ * `-` or `+` signs) into `values`
+ *
+ * \see clam_list_parse_u64
+ */
+/*@
+  @ requires \valid_read(input + (0 .. length - 1));
+  @ requires \valid(values + (0 .. capacity - 1));
+  @ requires errors == \null || \valid(errors + (0 .. capacity - 1));
+  @ assigns values[0 .. capacity - 1], errors[0 .. capacity - 1];
+  @*/
+CLAM_API size_t
+         clam_list_parse_i64(
+           const char   *input,
+           size_t        length,
+           char          delimiter,
+           int64_t      *values,
+           clam_error_t *errors,
+           size_t        capacity
+         )
+{
+         return clam__list_parse(input, length, delimiter, values, CLAM__LIST_I64, errors, capacity);
+}
+
+/// \cond clam_internal
+/*
+ * Matches a decimal number below `bits`
+ */
+/*@
+  @ requires valid_read_string(input);
+  @ requires \valid(value);
+  @ requires \valid(error);
+  @ assigns *value, *error;
+  @*/
+CLAM_API clam_match_result_t
+         clam__match_bit_index(
+           const char * restrict   input,
+           size_t                  bits,
+           uint64_t * restrict     value,
+           clam_error_t * restrict error
+         )
+{
+         clam_match_result_t i = clam_match_unsigned_integer10(input);
+
+         if (!i) {
+                 return clam__set_error(error, CLAM_ERROR_INVALID);
+         }
+         if (!clam__decimal(input, i, value) || *value >= bits) {
+                 return clam__set_error(error, CLAM_ERROR_RANGE);
+         }
+         return i;
+}
+
+/*
+ * Sets every `stride`-th bit from `first` to `last` a word at a time,
+ * returning non-zero if any of them was already set
+ */
+/*@
+  @ requires first <= last;
+  @ requires stride > 0;
+  @ requires \valid(bitmap + (first / 64 .. last / 64));
+  @ assigns bitmap[first / 64 .. last / 64];
+  @*/
+CLAM_API int
+         clam__bitmap_fill(
+           uint64_t *bitmap,
+           uint64_t  first,
+           uint64_t  last,
+           uint64_t  stride
+         )
+{
+         uint64_t overlap = 0, pattern = 1, width, word, offset, shift;
+
+         if (stride >= 64) {
+                 // At most one bit per word
+                 /*@
+                   @ loop assigns first, overlap, bitmap[first / 64 .. last / 64];
+                   @*/
+                 for (; first <= last; first += stride) {
+                         uint64_t bit = UINT64_C(1) << (first % 64);
+                         overlap |= bitmap[first / 64] & bit;
+                         bitmap[first / 64] |= bit;
+                         if (last - first < stride) {
+                                 break;
+                         }
+                 }
+                 return overlap != 0;
+         }
+         // Every `stride`-th bit of a word, by doubling
+         /*@
+           @ loop assigns pattern, width;
+           @*/
+         for (width = stride; width < 64; width *= 2) {
+                 pattern |= pattern << width;
+         }
+         // The members of the next word start `shift` bits earlier (modulo
+         // `stride`) than those of the current one
+         shift = 64 % stride;
+         offset = first % 64;
+         /*@
+           @ loop assigns word, offset, overlap, bitmap[first / 64 .. last / 64];
+           @*/
+         for (word = first / 64; word <= last / 64; word++) {
+                 uint64_t mask = pattern << offset;
+                 if (word == last / 64) {
+                         mask &= UINT64_MAX >> (63 - last % 64);
+                 }
+                 overlap |= bitmap[word] & mask;
+                 bitmap[word] |= mask;
+                 offset %= stride;
+                 offset = offset >= shift ? offset - shift : offset + stride - shift;
+         }
+         return overlap != 0;
+}
+/// \endcond
+
+/**
+ * Matches a list of numbers and ranges in Linux cpulist syntax (`0-3,8-11,16`,
+ * `0-63:2`) and sets the corresponding bits of `bitmap`
+ *
+ * `bitmap` holds `bits` bits, bit `n` being bit `n % 64` of `bitmap[n / 64]`
+ * (the layout of `cpu_set_t` on 64-bit Linux), and is cleared first. A range
+ * `a-b:s` includes every `s`-th number from `a` to `b`.
+ *
+ * If nothing is matched, `*error` (unless it is `NULL`) is set to
+ * `CLAM_ERROR_INVALID` for malformed lists and reversed ranges,
+ * `CLAM_ERROR_RANGE` for numbers not below `bits` and `CLAM_ERROR_DUPLICATE`
+ * for ranges that overlap, and `bitmap` is left partially filled.
+ *
+ * Ranges are filled a word at a time, checking for overlaps as they go.
+ */
+/*@
+  @ requires valid_read_string(input);
+  @ requires \valid(bitmap + (0 .. (bits + 63) / 64 - 1));
+  @ requires error == \null || \valid(error);
+  @ assigns bitmap[0 .. (bits + 63) / 64 - 1], *error;
+  @*/
+CLAM_API clam_match_result_t
+         clam_match_cpulist(
+           const char * restrict   input,
+           uint64_t * restrict     bitmap,
+           size_t                  bits,
+           clam_error_t * restrict error
+         )
+{
+         clam_match_result_t i = 0, n;
+         clam_error_t status;
+
+         memset(bitmap, 0, (bits + 63) / 64 * sizeof(*bitmap));
+         /*@
+           @ loop assigns i, n, status, bitmap[0 .. (bits + 63) / 64 - 1];
+           @*/
+         for (;;) {
+                 uint64_t first, last, stride = 1;
+                 if (!(n = clam__match_bit_index(input + i, bits, &first, &status))) {
+                         return clam__set_error(error, status);
+                 }
+                 i += n;
+                 last = first;
+                 if (input[i] == '-') {
+                         if (!(n = clam__match_bit_index(input + i + 1, bits, &last, &status))) {
+                                 return clam__set_error(error, status);
+                         }
+                         i += 1 + n;
+                         if (last < first) {
+                                 return clam__set_error(error, CLAM_ERROR_INVALID);
+                         }
+                         if (input[i] == ':') {
+                                 if (!(n = clam_match_unsigned_integer10(input + i + 1)) ||
+                                     !clam__decimal(input + i + 1, n, &stride) || stride == 0) {
+                                         return clam__set_error(error, CLAM_ERROR_INVALID);
+                                 }
+                                 i += 1 + n;
+                         }
+                 }
+                 if (clam__bitmap_fill(bitmap, first, last, stride)) {
+                         return clam__set_error(error, CLAM_ERROR_DUPLICATE);
+                 }
+                 if (input[i] != ',') {
+                         return i;
+                 }
+                 i++;
+         }
+}
+
+/**@}*/
+
+/**
+ * \defgroup overrides Configuration overrides
+ *
+ * Dotted-path configuration overrides (`-c server.pool.size=64`)
+ *
+ * \ref clam_match_override splits an override into its key path and value;
+ * \ref clam_overrides_set stores it in a tree with a node per key segment,
+ * so that a path or a whole subtree can be looked up in time proportional
+ * to the length of its path, however many overrides there are.
+ *
+ * All storage is caller-provided: nodes, a hash table of node indices
+ * (keyed by parent and segment) and an arena holding every key segment once.
+ * Values are not copied and must remain valid.
+ *
+ * \code{.c}
+ * clam_override_t nodes[256];
+ * uint32_t slots[512];
+ * char arena[4096];
+ * clam_overrides_t overrides;
+ * clam_overrides_init(&overrides, nodes, 256, slots, 512, arena, 4096);
+ *
+ * clam_slice_t key, value;
+ * if (clam_match_override(arg, &key, &value)) {
+ *   clam_overrides_set(&overrides, key.ptr, key.len, value.ptr, value.len);
+ * }
+ *
+ * int pool = clam_overrides_find(&overrides, "server.pool", 11);
+ * uint32_t cursor = 0;
+ * while (pool >= 0 && clam_overrides_next(&overrides, pool, &cursor)) {
+ *   // overrides.nodes[cursor].value
+ * }
+ * \endcode
+ *
+ * @{
+ */
+
+/**
+ * Node of \ref clam_overrides_t, one per key segment
+ *
+ * Links are node indices; node `0` is the root (the empty path), so `0`
+ * also stands for "none".
+ */
+typedef struct {
+        /** Offset of the segment in the arena */
+        uint32_t    segment;
+        /** Length of the segment */
+        uint32_t    length;
+        uint32_t    parent;
+        /** First and last child, in the order they were added */
+        uint32_t    child, last;
+        uint32_t    sibling;
+        /** Value, or `NULL` if this path was not overridden itself */
+        const char *value;
+        size_t      value_length;
+} clam_override_t;
+
+/**
+ * Override store, see \ref clam_overrides_init
+ */
+typedef struct {
+        clam_override_t *nodes;
+        uint32_t         capacity;
+        uint32_t         count;
+        /** Open-addressed table of node indices (`0` if empty) */
+        uint32_t        *slots;
+        uint32_t         nslots;
+        char            *arena;
+        size_t           arena_capacity;
+        size_t           arena_size;
+} clam_overrides_t;
+
+/**
+ * Matches an override: a key path of one or more segments (letters, digits,
+ * `_` and `-`) separated by `.`, followed by `=` and a value running to the
+ * end of `input`
+ *
+ * Sets `*key` and `*value` to the respective parts of `input` on success.
+ */
+/*@
+  @ requires valid_read_string(input);
+  @ requires \valid(key) && \valid(value);
+  @ assigns *key, *value;
+  @*/
+CLAM_API clam_match_result_t
+         clam_match_override(
+           const char * restrict   input,
+           clam_slice_t * restrict key,
+           clam_slice_t * restrict value
+         )
+{
+         clam_match_result_t i = 0, start = 0;
+
+         /*@
+           @ loop assigns i, start;
+           @*/
+         for (;;) {
+                 while (clam_match_alphanumeric_char(input + i) || input[i] == '_' || input[i] == '-') {
+                         i++;
+                 }
+                 if (i == start) {
+                         return 0;
+                 }
+                 if (input[i] != '.') {
+                         break;
+                 }
+                 start = ++i;
+         }
+         if (input[i] != '=') {
+                 return 0;
+         }
+         key->ptr = input;
+         key->len = i;
+         value->ptr = input + i + 1;
+         value->len = strlen(input + i + 1);
+         return i + 1 + value->len;
+}
+
+/**
+ * Initializes an empty override store over caller-provided storage
+ *
+ * `nodes` holds up to `capacity` nodes (including the root), `slots` must
+ * have a power of two entries, at least `capacity`, and `arena` holds the
+ * key segments. Returns `CLAM_ERROR_INVALID` if these do not hold.
+ */
+/*@
+  @ requires \valid(overrides);
+  @ requires \valid(nodes + (0 .. capacity - 1));
+  @ requires \valid(slots + (0 .. nslots - 1));
+  @ requires \valid(arena + (0 .. arena_capacity - 1));
+  @ assigns *overrides, nodes[0], slots[0 .. nslots - 1];
+  @*/
+CLAM_API clam_error_t
+         clam_overrides_init(
+           clam_overrides_t *overrides,
+           clam_override_t  *nodes,
+           uint32_t          capacity,
+           uint32_t         *slots,
+           uint32_t          nslots,
+           char             *arena,
+           size_t            arena_capacity
+         )
+{
+         if (capacity == 0 || nslots < capacity || (nslots & (nslots - 1))) {
+                 return CLAM_ERROR_INVALID;
+         }
+         memset(&nodes[0], 0, sizeof(nodes[0]));
+         memset(slots, 0, nslots * sizeof(*slots));
+         overrides->nodes = nodes;
+         overrides->capacity = capacity;
+         overrides->count = 1;
+         overrides->slots = slots;
+         overrides->nslots = nslots;
+         overrides->arena = arena;
+         overrides->arena_capacity = arena_capacity;
+         overrides->arena_size = 0;
+         return CLAM_ERROR_NONE;
+}
+
+/// \cond clam_internal
+/*
+ * Returns the slot of the child of `parent` named by `length` characters at
+ * `segment`: the slot holding it, or the empty slot where it would go
+ */
+/*@
+  @ requires \valid(overrides);
+  @ requires \valid_read(segment + (0 .. length - 1));
+  @ assigns \nothing;
+  @ ensures \result < overrides->nslots;
+  @*/
+CLAM_API uint32_t
+         clam__overrides_slot(
+           const clam_overrides_t *overrides,
+           uint32_t                parent,
+           const char             *segment,
+           size_t                  length
+         )
+{
+         // FNV-1a over the segment, seeded with the parent
+         uint32_t hash = 2166136261u ^ (parent * 0x9e3779b9u), slot;
+         size_t i;
+
+         /*@
+           @ loop assigns i, hash;
+           @*/
+         for (i = 0; i < length; i++) {
+                 hash = (hash ^ (unsigned char) segment[i]) * 16777619u;
+         }
+         /*@
+           @ loop assigns slot, hash;
+           @*/
+         for (;; hash++) {
+                 const clam_override_t *node;
+                 slot = hash & (overrides->nslots - 1);
+                 if (!overrides->slots[slot]) {
+                         return slot;
+                 }
+                 node = &overrides->nodes[overrides->slots[slot]];
+                 if (node->parent == parent && node->length == length &&
+                     !memcmp(overrides->arena + node->segment, segment, length)) {
+                         return slot;
+                 }
+         }
+}
+/// \endcond
+
+/**
+ * Returns the node of the `length`-character key path at `path` (`0`, the
+ * root, for an empty path), or `-1` if nothing under it has been set
+ */
+/*@
+  @ requires \valid(overrides);
+  @ requires \valid_read(path + (0 .. length - 1));
+  @ assigns \nothing;
+  @ ensures -1 <= \result < overrides->count;
+  @*/
+CLAM_API int
+         clam_overrides_find(
+           const clam_overrides_t *overrides,
+           const char             *path,
+           size_t                  length
+         )
+{
+         uint32_t node = 0;
+         size_t start = 0, end;
+
+         if (length == 0) {
+                 return 0;
+         }
+         /*@
+           @ loop assigns start, end, node;
+           @*/
+         for (;;) {
+                 const char *dot = (const char *) memchr(path + start, '.', length - start);
+                 end = dot ? (size_t) (dot - path) : length;
+                 if (!(node = overrides->slots[clam__overrides_slot(overrides, node, path + start, end - start)])) {
+                         return -1;
+                 }
+                 if (end == length) {
+                         return (int) node;
+                 }
+                 start = end + 1;
+         }
+}
+
+/**
+ * Sets the `length`-character key path at `path` to `value` (which is not
+ * copied), replacing any earlier value
+ *
+ * Returns `CLAM_ERROR_INVALID` if the path has an empty segment, or
+ * `CLAM_ERROR_CAPACITY` if it needs more nodes or arena than are left (in
+ * which case some of its leading segments may have been added).
+ */
+/*@
+  @ requires \valid(overrides);
+  @ requires \valid_read(path + (0 .. length - 1));
+  @ requires \valid_read(value + (0 .. value_length - 1));
+  @*/
+CLAM_API clam_error_t
+         clam_overrides_set(
+           clam_overrides_t *overrides,
+           const char       *path,
+           size_t            length,
+           const char       *value,
+           size_t            value_length
+         )
+{
+         uint32_t node = 0;
+         size_t start = 0, end;
+
+         /*@
+           @ loop assigns start, end, node, *overrides;
+           @*/
+         for (;;) {
+                 const char *dot = (const char *) memchr(path + start, '.', length - start);
+                 uint32_t slot;
+                 end = dot ? (size_t) (dot - path) : length;
+                 if (end == start) {
+                         return CLAM_ERROR_INVALID;
+                 }
+                 slot = clam__overrides_slot(overrides, node, path + start, end - start);
+                 if (overrides->slots[slot]) {
+                         node = overrides->slots[slot];
+                 } else {
+                         clam_override_t *child;
+                         if (overrides->count == overrides->capacity ||
+                             overrides->arena_capacity - overrides->arena_size < end - start) {
+                                 return CLAM_ERROR_CAPACITY;
+                         }
+                         child = &overrides->nodes[overrides->count];
+                         memcpy(overrides->arena + overrides->arena_size, path + start, end - start);
+                         child->segment = (uint32_t) overrides->arena_size;
+                         child->length = (uint32_t) (end - start);
+                         child->parent = node;
+                         child->child = child->last = child->sibling = 0;
+                         child->value = NULL;
+                         child->value_length = 0;
+                         overrides->arena_size += end - start;
+                         if (overrides->nodes[node].last) {
+                                 overrides->nodes[overrides->nodes[node].last].sibling = overrides->count;
+                         } else {
+                                 overrides->nodes[node].child = overrides->count;
+                         }
+                         overrides->nodes[node].last = overrides->count;
+                         overrides->slots[slot] = node = overrides->count++;
+                 }
+                 if (end == length) {
+                         break;
+                 }
+                 start = end + 1;
+         }
+         overrides->nodes[node].value = value;
+         overrides->nodes[node].value_length = value_length;
+         return CLAM_ERROR_NONE;
+}
+
+/**
+ * Advances `*cursor` (initially zero) to the next node with a value in the
+ * subtree of `node` (including itself), in the order the paths were added
+ *
+ * Returns zero when there are no more.
+ */
+/*@
+  @ requires \valid(overrides);
+  @ requires node < overrides->count;
+  @ requires \valid(cursor);
+  @ assigns *cursor;
+  @*/
+CLAM_API int
+         clam_overrides_next(
+           const clam_overrides_t *overrides,
+           uint32_t                node,
+           uint32_t               *cursor
+         )
+{
+         const clam_override_t *nodes = overrides->nodes;
+         uint32_t n = *cursor;
+
+         if (!n) {
+                 n = node;
+                 if (n && nodes[n].value) {
+                         *cursor = n;
+                         return 1;
+                 }
+         }
+         /*@
+           @ loop assigns n;
+           @*/
+         for (;;) {
+                 // Pre-order: first child, else the next sibling of the
+                 // nearest ancestor (within the subtree) that has one
+                 if (nodes[n].child) {
+                         n = nodes[n].child;
+                 } else {
+                         while (n != node && !nodes[n].sibling) {
+                                 n = nodes[n].parent;
+                         }
+                         if (n == node) {
+                                 return 0;
+                         }
+                         n = nodes[n].sibling;
+                 }
+                 if (nodes[n].value) {
+                         *cursor = n;
+                         return 1;
+                 }
+         }
+}
+
+/**
+ * Writes the full key path of `node` to `output` if it fits into `capacity`
+ * characters, and returns its length
+ */
+/*@
+  @ requires \valid(overrides);
+  @ requires node < overrides->count;
+  @ requires \valid(output + (0 .. capacity - 1));
+  @ assigns output[0 .. capacity - 1];
+  @*/
+CLAM_API size_t
+         clam_overrides_key(
+           const clam_overrides_t *overrides,
+           uint32_t                node,
+           char                   *output,
+           size_t                  capacity
+         )
+{
+         size_t length = 0, end;
+         uint32_t n;
+
+         /*@
+           @ loop assigns n, length;
+           @*/
+         for (n = node; n; n = overrides->nodes[n].parent) {
+                 length += overrides->nodes[n].length + (overrides->nodes[n].parent != 0);
+         }
+         if (length > capacity) {
+                 return length;
+         }
+         end = length;
+         /*@
+           @ loop assigns n, end, output[0 .. length - 1];
+           @*/
+         for (n = node; n; n = overrides->nodes[n].parent) {
+                 const clam_override_t *segment = &overrides->nodes[n];
+                 end -= segment->length;
+                 memcpy(output + end, overrides->arena + segment->segment, segment->length);
+                 if (segment->parent) {
+                         output[--end] = '.';
+                 }
+         }
+         return length;
+}
+
+/**@}*/
+
+/**
+ * \defgroup constraints Option constraints
+ *
+ * Checking relations between options once they are parsed
+ *
+ * Options are identified by small integers (such as the ids of a schema).
+ * While parsing, every option seen is added to a \ref clam_option_set_t;
+ * afterwards \ref clam_constraints_check evaluates all declared
+ * constraints against it, each as a few word-wide mask operations, and
+ * reports the first one that does not hold.
+ *
+ * \code{.c}
+ * clam_constraint_t storage[8];
+ * clam_constraints_t constraints;
+ * clam_constraints_init(&constraints, storage, 8);
+ * clam_constraints_requires(&constraints, OPT_OUTPUT, (const int[]){OPT_FORMAT}, 1);
+ * clam_constraints_conflicts(&constraints, OPT_QUIET, (const int[]){OPT_VERBOSE}, 1);
+ * clam_constraints_exactly_one(&constraints, (const int[]){OPT_CREATE, OPT_EXTRACT, OPT_LIST}, 3);
+ *
+ * clam_option_set_t seen;
+ * clam_option_set_clear(&seen);
+ * // clam_option_set_add(&seen, id) for every option parsed
+ *
+ * clam_violation_t violation;
+ * if (clam_constraints_check(&constraints, &seen, &violation) >= 0) {
+ *   // violation.kind, violation.option, violation.options
+ * }
+ * \endcode
+ *
+ * @{
+ */
+
+#ifndef CLAM_MAX_OPTIONS
+/**
+ * Number of option ids a \ref clam_option_set_t can hold
+ *
+ * Can be redefined externally (must be a multiple of 64).
+ */
+#define CLAM_MAX_OPTIONS 256
+#endif
+
+/**
+ * Set of option ids
+ */
+typedef struct {
+        uint64_t words[CLAM_MAX_OPTIONS / 64];
+} clam_option_set_t;
+
+/**
+ * Kind of \ref clam_constraint_t
+ */
+typedef enum {
+        /** `option` requires all of `options` */
+        CLAM_CONSTRAINT_REQUIRES,
+        /** `option` conflicts with each of `options` */
+        CLAM_CONSTRAINT_CONFLICTS,
+        /** `option` implies all of `options` (adds them, never violated) */
+        CLAM_CONSTRAINT_IMPLIES,
+        /** Exactly one of `options` */
+        CLAM_CONSTRAINT_EXACTLY_ONE,
+        /** At most one of `options` */
+        CLAM_CONSTRAINT_AT_MOST_ONE,
+        /** At least one of `options` */
+        CLAM_CONSTRAINT_AT_LEAST_ONE,
+} clam_constraint_kind_t;
+
+/**
+ * Constraint, created by `clam_constraints_XXX` functions
+ */
+typedef struct {
+        clam_constraint_kind_t kind;
+        /** Option the constraint applies to, `-1` for groups */
+        int                    option;
+        clam_option_set_t      options;
+} clam_constraint_t;
+
+/**
+ * Constraints under construction, stored in caller-provided storage
+ */
+typedef struct {
+        clam_constraint_t *constraints;
+        int                capacity;
+        int                count;
+} clam_constraints_t;
+
+/**
+ * Constraint that does not hold, see \ref clam_constraints_check
+ */
+typedef struct {
+        /** Index of the constraint */
+        int                    constraint;
+        clam_constraint_kind_t kind;
+        /** Option the constraint applies to, `-1` for groups */
+        int                    option;
+        /**
+         * Options involved: those missing for `CLAM_CONSTRAINT_REQUIRES`,
+         * those seen otherwise
+         */
+        clam_option_set_t      options;
+} clam_violation_t;
+
+/**
+ * Empties `set`
+ */
+/*@
+  @ requires \valid(set);
+  @ assigns *set;
+  @*/
+CLAM_API void
+         clam_option_set_clear(
+           clam_option_set_t *set
+         )
+{
+         memset(set, 0, sizeof(*set));
+}
+
+/**
+ * Adds `option` to `set`
+ */
+/*@
+  @ requires \valid(set);
+  @ requires 0 <= option < CLAM_MAX_OPTIONS;
+  @ assigns set->words[option / 64];
+  @*/
+CLAM_API void
+         clam_option_set_add(
+           clam_option_set_t *set,
+           int                option
+         )
+{
+         set->words[option / 64] |= UINT64_C(1) << (option % 64);
+}
+
+/**
+ * Returns non-zero if `option` is in `set`
+ */
+/*@
+  @ requires \valid_read(set);
+  @ requires 0 <= option < CLAM_MAX_OPTIONS;
+  @ assigns \nothing;
+  @*/
+CLAM_API int
+         clam_option_set_has(
+           const clam_option_set_t *set,
+           int                      option
+         )
+{
+         return (set->words[option / 64] >> (option % 64)) & 1;
+}
+
+/**
+ * Advances `*option` (initially `-1`) to the next option in `set`
+ *
+ * Returns zero when there are no more.
+ */
+/*@
+  @ requires \valid_read(set);
+  @ requires \valid(option);
+  @ requires -1 <= *option < CLAM_MAX_OPTIONS;
+  @ assigns *option;
+  @*/
+CLAM_API int
+         clam_option_set_next(
+           const clam_option_set_t *set,
+           int                     *option
+         )
+{
+         int next = *option + 1;
+
+         /*@
+           @ loop assigns next;
+           @*/
+         while (next < CLAM_MAX_OPTIONS) {
+                 uint64_t word = set->words[next / 64] >> (next % 64);
+                 if (word) {
+                         uint32_t low = (uint32_t) word;
+                         *option = next + (low ? clam__ctz32(low) : 32 + clam__ctz32((uint32_t) (word >> 32)));
+                         return 1;
+                 }
+                 next = (next / 64 + 1) * 64;
+         }
+         return 0;
+}
+
+/**
+ * Initializes an empty set of constraints over `capacity` caller-provided
+ * `storage` entries
+ */
+/*@
+  @ requires \valid(constraints);
+  @ requires capacity >= 0;
+  @ requires \valid(storage + (0 .. capacity - 1));
+  @ assigns *constraints;
+  @ ensures constraints->count == 0;
+  @*/
+CLAM_API void
+         clam_constraints_init(
+           clam_constraints_t *constraints,
+           clam_constraint_t  *storage,
+           int                 capacity
+         )
+{
+         constraints->constraints = storage;
+         constraints->capacity = capacity;
+         constraints->count = 0;
+}
+
+/// \cond clam_internal
+/*@
+  @ requires \valid(constraints);
+  @ requires \valid(constraints->constraints + (0 .. constraints->capacity - 1));
+  @ requires \valid_read(options + (0 .. count - 1));
+  @ assigns constraints->count, constraints->constraints[constraints->count];
+  @ ensures \result == -1 || \result == \old(constraints->count);
+  @*/
+CLAM_API int
+         clam__constraint(
+           clam_constraints_t     *constraints,
+           clam_constraint_kind_t  kind,
+           int                     option,
+           const int              *options,
+           size_t                  count
+         )
+{
+         clam_constraint_t *constraint;
+         size_t i;
+
+         if (constraints->count >= constraints->capacity || option < -1 || option >= CLAM_MAX_OPTIONS) {
+                 return -1;
+         }
+         constraint = &constraints->constraints[constraints->count];
+         clam_option_set_clear(&constraint->options);
+         /*@
+           @ loop assigns i, constraint->options;
+           @*/
+         for (i = 0; i < count; i++) {
+                 if (options[i] < 0 || options[i] >= CLAM_MAX_OPTIONS) {
+                         return -1;
+                 }
+                 clam_option_set_add(&constraint->options, options[i]);
+         }
+         constraint->kind = kind;
+         constraint->option = option;
+         return constraints->count++;
+}
+/// \endcond
+
+/**
+ * Adds a constraint that `option` requires all of the `count` `options`
+ *
+ * Returns the index of the constraint or `-1` if there is no room or an
+ * option id is out of range.
+ */
+/*@
+  @ requires \valid(constraints);
+  @ requires \valid_read(options + (0 .. count - 1));
+  @ assigns constraints->count, constraints->constraints[constraints->count];
+  @*/
+CLAM_API int
+         clam_constraints_requires(
+           clam_constraints_t *constraints,
+           int                 option,
+           const int          *options,
+           size_t              count
+         )
+{
+         return option < 0 ? -1 : clam__constraint(constraints, CLAM_CONSTRAINT_REQUIRES, option, options, count);
+}
+
+/**
+ * Adds a constraint that `option` conflicts with each of the `count`
+ * `options`
+ *
+ * \see clam_constraints_requires
+ */
+/*@
+  @ requires \valid(constraints);
+  @ requires \valid_read(options + (0 .. count - 1));
+  @ assigns constraints->count, constraints->constraints[constraints->count];
+  @*/
+CLAM_API int
+         clam_constraints_conflicts(
+           clam_constraints_t *constraints,
+           int                 option,
+           const int          *options,
+           size_t              count
+         )
+{
+         return option < 0 ? -1 : clam__constraint(constraints, CLAM_CONSTRAINT_CONFLICTS, option, options, count);
+}
+
+/**
+ * Adds an implication: if `option` is seen, the `count` `options` are
+ * considered seen too (before any other constraint is checked)
+ *
+ * \see clam_constraints_requires
+ */
+/*@
+  @ requires \valid(constraints);
+  @ requires \valid_read(options + (0 .. count - 1));
+  @ assigns constraints->count, constraints->constraints[constraints->count];
+  @*/
+CLAM_API int
+         clam_constraints_implies(
+           clam_constraints_t *constraints,
+           int                 option,
+           const int          *options,
+           size_t              count
+         )
+{
+         return option < 0 ? -1 : clam__constraint(constraints, CLAM_CONSTRAINT_IMPLIES, option, options, count);
+}
+
+/**
+ * Adds a constraint that exactly one of the `count` `options` is seen
+ *
+ * \see clam_constraints_requires
+ */
+/*@
+  @ requires \valid(constraints);
+  @ requires \valid_read(options + (0 .. count - 1));
+  @ assigns constraints->count, constraints->constraints[constraints->count];
+  @*/
+CLAM_API int
+         clam_constraints_exactly_one(
+           clam_constraints_t *constraints,
+           const int          *options,
+           size_t              count
+         )
+{
+         return clam__constraint(constraints, CLAM_CONSTRAINT_EXACTLY_ONE, -1, options, count);
+}
+
+/**
+ * Adds a constraint that at most one of the `count` `options` is seen
+ *
+ * \see clam_constraints_requires
+ */
+/*@
+  @ requires \valid(constraints);
+  @ requires \valid_read(options + (0 .. count - 1));
+  @ assigns constraints->count, constraints->constraints[constraints->count];
+  @*/
+CLAM_API int
+         clam_constraints_at_most_one(
+           clam_constraints_t *constraints,
+           const int          *options,
+           size_t              count
+         )
+{
+         return clam__constraint(constraints, CLAM_CONSTRAINT_AT_MOST_ONE, -1, options, count);
+}
+
+/**
+ * Adds a constraint that at least one of the `count` `options` is seen
+ *
+ * \see clam_constraints_requires
+ */
+/*@
+  @ requires \valid(constraints);
+  @ requires \valid_read(options + (0 .. count - 1));
+  @ assigns constraints->count, constraints->constraints[constraints->count];
+  @*/
+CLAM_API int
+         clam_constraints_at_least_one(
+           clam_constraints_t *constraints,
+           const int          *options,
+           size_t              count
+         )
+{
+         return clam__constraint(constraints, CLAM_CONSTRAINT_AT_LEAST_ONE, -1, options, count);
+}
+
+/**
+ * Checks `constraints` against the options in `seen`
+ *
+ * Implications are applied to `seen` first (repeatedly, so that they
+ * chain). Returns the index of the first constraint that does not hold,
+ * describing it in `*violation` (unless it is `NULL`), or `-1` if all hold.
+ */
+/*@
+  @ requires \valid_read(constraints);
+  @ requires \valid_read(constraints->constraints + (0 .. constraints->count - 1));
+  @ requires \valid(seen);
+  @ requires violation == \null || \valid(violation);
+  @ assigns *seen, *violation;
+  @*/
+CLAM_API int
+         clam_constraints_check(
+           const clam_constraints_t *constraints,
+           clam_option_set_t        *seen,
+           clam_violation_t         *violation
+         )
+{
+         const clam_constraint_t *c = constraints->constraints;
+         int i, changed = 1;
+         size_t w;
+
+         /*@
+           @ loop assigns i, w, changed, *seen;
+           @*/
+         while (changed) {
+                 changed = 0;
+                 for (i = 0; i < constraints->count; i++) {
+                         if (c[i].kind == CLAM_CONSTRAINT_IMPLIES && clam_option_set_has(seen, c[i].option)) {
+                                 for (w = 0; w < CLAM_MAX_OPTIONS / 64; w++) {
+                                         changed |= (c[i].options.words[w] & ~seen->words[w]) != 0;
+                                         seen->words[w] |= c[i].options.words[w];
+                                 }
+                         }
+                 }
+         }
+         /*@
+           @ loop assigns i, w;
+           @*/
+         for (i = 0; i < constraints->count; i++) {
+                 clam_option_set_t involved;
+                 uint64_t any = 0, many = 0;
+                 int holds;
+                 if (c[i].option >= 0 && !clam_option_set_has(seen, c[i].option)) {
+                         continue;
+                 }
+                 /*@
+                   @ loop assigns w, any, many, involved;
+                   @*/
+                 for (w = 0; w < CLAM_MAX_OPTIONS / 64; w++) {
+                         uint64_t word = c[i].kind == CLAM_CONSTRAINT_REQUIRES ? c[i].options.words[w] & ~seen->words[w]
+                                                                                : c[i].options.words[w] & seen->words[w];
+                         // More than one bit in total: within the word, or
+                         // across words
+                         many |= (word & (word - 1)) | (uint64_t) (any && word);
+                         any |= word;
+                         involved.words[w] = word;
+                 }
+                 switch (c[i].kind) {
+                 case CLAM_CONSTRAINT_EXACTLY_ONE:
+                         holds = any && !many;
+                         break;
+                 case CLAM_CONSTRAINT_AT_MOST_ONE:
+                         holds = !many;
+                         break;
+                 case CLAM_CONSTRAINT_AT_LEAST_ONE:
+                         holds = any != 0;
+                         break;
+                 case CLAM_CONSTRAINT_IMPLIES:
+                         holds = 1;
+                         break;
+                 default:
+                         // Nothing missing or nothing conflicting
+                         holds = !any;
+                         break;
+                 }
+                 if (!holds) {
+                         if (violation) {
+                                 violation->constraint = i;
+                                 violation->kind = c[i].kind;
+                                 violation->option = c[i].option;
+                                 violation->options = involved;
+                         }
+                         return i;
+                 }
+         }
+         return -1;
+}
+
+/**@}*/
+
+/**
+ * \defgroup records Parse records
+ *
+ * Compact log of what was parsed, for later stages
+ *
+ * A \ref clam_record_t keeps one event per option parsed (option id, index
+ * of the argument, offset and length of its value within the argument and
+ * polarity) in parallel arrays carved from a caller-provided arena. Later
+ * stages can look options up in the log instead of walking `argv` and
+ * running the matchers again.
+ *
+ * \code{.c}
+ * uint32_t arena[1024];
+ * clam_record_t record;
+ * clam_record_init(&record, arena, sizeof(arena));
+ *
+ * // while parsing `argv[a]` as `--define=value`:
+ * clam_record_add(&record, OPT_DEFINE, a, strlen("--define="), strlen(value), 1);
+ *
+ * // later:
+ * uint32_t defines[16];
+ * size_t n = clam_record_filter(&record, OPT_DEFINE, defines, 16);
+ * \endcode
+ *
+ * Lookups by option id compare eight ids at a time with SSE2.
+ *
+ * @{
+ */
+
+/**
+ * Log of parse events, see \ref clam_record_init
+ *
+ * Event `k` is described by element `k` of each array.
+ */
+typedef struct {
+        /** Argument index */
+        uint32_t *args;
+        /** Offset of the value within the argument */
+        uint32_t *offsets;
+        /** Length of the value (zero if none) */
+        uint32_t *lengths;
+        /** Option id */
+        uint16_t *ids;
+        /** Non-zero for `--option`, zero for negated forms (`--no-option`) */
+        uint8_t  *polarities;
+        size_t    count;
+        size_t    capacity;
+} clam_record_t;
+
+/**
+ * Initializes an empty `record` in the `size` bytes at `arena` (which should
+ * be aligned for `uint32_t`)
+ *
+ * Returns the number of events the arena can hold.
+ */
+/*@
+  @ requires \valid(record);
+  @ requires \valid((char *) arena + (0 .. size - 1));
+  @ assigns *record;
+  @ ensures record->count == 0;
+  @*/
+CLAM_API size_t
+         clam_record_init(
+           clam_record_t *record,
+           void          *arena,
+           size_t         size
+         )
+{
+         // Widest arrays first, so that every array stays aligned
+         size_t capacity = size / (3 * sizeof(uint32_t) + sizeof(uint16_t) + sizeof(uint8_t));
+         char *p = (char *) arena;
+
+         record->args = (uint32_t *) p;
+         record->offsets = (uint32_t *) (p += capacity * sizeof(uint32_t));
+         record->lengths = (uint32_t *) (p += capacity * sizeof(uint32_t));
+         record->ids = (uint16_t *) (p += capacity * sizeof(uint32_t));
+         record->polarities = (uint8_t *) (p + capacity * sizeof(uint16_t));
+         record->count = 0;
+         record->capacity = capacity;
+         return capacity;
+}
+
+/**
+ * Appends an event to `record`
+ *
+ * Returns `CLAM_ERROR_CAPACITY` if the arena is full.
+ */
+/*@
+  @ requires \valid(record);
+  @ assigns record->count, record->args[record->count], record->offsets[record->count],
+  @         record->lengths[record->count], record->ids[record->count],
+  @         record->polarities[record->count];
+  @*/
+CLAM_API clam_error_t
+         clam_record_add(
+           clam_record_t *record,
+           uint16_t       id,
+           uint32_t       arg,
+           uint32_t       offset,
+           uint32_t       length,
+           int            polarity
+         )
+{
+         size_t k = record->count;
+
+         if (k == record->capacity) {
+                 return CLAM_ERROR_CAPACITY;
+         }
+         record->args[k] = arg;
+         record->offsets[k] = offset;
+         record->lengths[k] = length;
+         record->ids[k] = id;
+         record->polarities[k] = polarity != 0;
+         record->count = k + 1;
+         return CLAM_ERROR_NONE;
+}
+
+/**
+ * Returns the index of the first event of option `id` at or after `start`,
+ * or `record->count` if there is none
+ */
+/*@
+  @ requires \valid_read(record);
+  @ requires start <= record->count;
+  @ assigns \nothing;
+  @ ensures start <= \result <= record->count;
+  @*/
+CLAM_API size_t
+         clam_record_find(
+           const clam_record_t *record,
+           uint16_t             id,
+           size_t               start
+         )
+{
+         const uint16_t *ids = record->ids;
+         size_t i = start, count = record->count;
+
+#ifdef CLAM__SSE2
+         const __m128i needle = _mm_set1_epi16((short) id);
+         for (; i + 8 <= count; i += 8) {
+                 uint32_t found = (uint32_t) _mm_movemask_epi8(
+                   _mm_cmpeq_epi16(_mm_loadu_si128((const __m128i *) (ids + i)), needle));
+                 if (found) {
+                         return i + (size_t) clam__ctz32(found) / 2;
+                 }
+         }
+#endif
+         /*@
+           @ loop invariant start <= i <= count;
+           @ loop assigns i;
+           @*/
+         for (; i < count; i++) {
+                 if (ids[i] == id) {
+                         return i;
+                 }
+         }
+         return count;
+}
+
+/**
+ * Returns the index of the last event of option `id` (the one that usually
+ * takes effect), or `record->count` if there is none
+ */
+/*@
+  @ requires \valid_read(record);
+  @ assigns \nothing;
+  @ ensures \result <= record->count;
+  @*/
+CLAM_API size_t
+         clam_record_last(
+           const clam_record_t *record,
+           uint16_t             id
+         )
+{
+         const uint16_t *ids = record->ids;
+         size_t i = record->count;
+
+#ifdef CLAM__SSE2
+         const __m128i needle = _mm_set1_epi16((short) id);
+         for (; i >= 8; i -= 8) {
+                 uint32_t found = (uint32_t) _mm_movemask_epi8(
+                   _mm_cmpeq_epi16(_mm_loadu_si128((const __m128i *) (ids + i - 8)), needle));
+                 if (found) {
+                         return i - 8 + (size_t) (31 - clam__clz32(found)) / 2;
+                 }
+         }
+#endif
+         /*@
+           @ loop assigns i;
+           @*/
+         while (i > 0) {
+                 if (ids[--i] == id) {
+                         return i;
+                 }
+         }
+         return record->count;
+}
+
+/**
+ * Stores the indices of the events of option `id` into `indices`, in order
+ *
+ * Returns the number of such events, of which only the first `capacity`
+ * are stored.
+ */
+/*@
+  @ requires \valid_read(record);
+  @ requires \valid(indices + (0 .. capacity - 1));
+  @ assigns indices[0 .. capacity - 1];
+  @*/
+CLAM_API size_t
+         clam_record_filter(
+           const clam_record_t *record,
+           uint16_t             id,
+           uint32_t            *indices,
+           size_t               capacity
+         )
+{
+         const uint16_t *ids = record->ids;
+         size_t i = 0, n = 0, count = record->count;
+
+#ifdef CLAM__SSE2
+         const __m128i needle = _mm_set1_epi16((short) id);
+         for (; i + 8 <= count; i += 8) {
+                 // One bit per matching id
+                 uint32_t found = (uint32_t) _mm_movemask_epi8(
+                   _mm_cmpeq_epi16(_mm_loadu_si128((const __m128i *) (ids + i)), needle)) & 0x5555;
+                 while (found) {
+                         if (n < capacity) {
+                                 indices[n] = (uint32_t) (i + (size_t) clam__ctz32(found) / 2);
+                         }
+                         n++;
+                         found &= found - 1;
+                 }
+         }
+#endif
+         /*@
+           @ loop assigns i, n, indices[0 .. capacity - 1];
+           @*/
+         for (; i < count; i++) {
+                 if (ids[i] == id) {
+                         if (n < capacity) {
+                                 indices[n] = (uint32_t) i;
+                         }
+                         n++;
+                 }
+         }
+         return n;
+}
+
+/**@}*/
+
+/**
+ * \defgroup snapshots Snapshots
+ *
+ * Handing a finished parse to other processes
+ *
+ * A snapshot is a single position-independent buffer holding a \ref
+ * clam_record_t, copies of its values and a list of positional arguments,
+ * preceded by a header with a layout version and a hash of the schema the
+ * option ids come from. It can be written into shared memory (such as a
+ * `memfd` inherited by child processes), which readers map and open
+ * without parsing the command line again.
+ *
+ * \code{.c}
+ * size_t size = clam_snapshot_write(&record, argv, positionals, npositionals, hash, NULL, 0);
+ * int fd = memfd_create("args", 0);
+ * ftruncate(fd, size);
+ * void *data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+ * clam_snapshot_write(&record, argv, positionals, npositionals, hash, data, size);
+ * // pass `fd` to children, which do:
+ *
+ * clam_snapshot_t snapshot;
+ * void *data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+ * if (clam_snapshot_open(&snapshot, data, size, hash, OPTIONS) != CLAM_ERROR_NONE) {
+ *   // parse argv instead
+ * }
+ * \endcode
+ *
+ * Snapshots use the byte order of the host that wrote them; a snapshot from
+ * a host with another byte order fails to open.
+ *
+ * @{
+ */
+
+/**
+ * Layout version of snapshots written by \ref clam_snapshot_write
+ */
+#define CLAM_SNAPSHOT_VERSION 1
+
+/**
+ * Snapshot header
+ *
+ * It is followed by the `uint32_t` arrays of the record (`args`, `offsets`,
+ * `lengths`), the `uint32_t` offsets and lengths of the positionals, the
+ * record's `ids` and `polarities` and finally the strings: every value and
+ * positional, each followed by a null character.
+ */
+typedef struct {
+        /** `CLAM` */
+        char     magic[4];
+        /** \ref CLAM_SNAPSHOT_VERSION */
+        uint32_t version;
+        /** Hash of the schema, see \ref clam_schema_hash */
+        uint64_t schema;
+        uint32_t events;
+        uint32_t positionals;
+        /** Total size of the strings */
+        uint32_t strings;
+        /** Total size of the snapshot */
+        uint32_t size;
+} clam_snapshot_header_t;
+
+/**
+ * Opened snapshot, see \ref clam_snapshot_open
+ *
+ * `record` refers to the snapshot's memory and must not be added to. Its
+ * `offsets` are offsets of the values in `strings` (rather than in
+ * arguments).
+ */
+typedef struct {
+        uint64_t        schema;
+        clam_record_t   record;
+        const uint32_t *positional_offsets;
+        const uint32_t *positional_lengths;
+        size_t          positionals;
+        const char     *strings;
+} clam_snapshot_t;
+
+/**
+ * Returns a hash of the `count` option `names` of a schema, in id order
+ *
+ * `clam::schema::hash()` (in `clam.hpp`) returns the same value at compile
+ * time.
+ */
+/*@
+  @ requires \valid_read(names + (0 .. count - 1));
+  @ assigns \nothing;
+  @*/
+CLAM_API uint64_t
+         clam_schema_hash(
+           const char *const *names,
+           size_t             count
+         )
+{
+         // FNV-1a over the names, each followed by a null character
+         uint64_t hash = UINT64_C(0xcbf29ce484222325);
+         size_t i;
+
+         /*@
+           @ loop assigns i, hash;
+           @*/
+         for (i = 0; i < count; i++) {
+                 const char *c = names[i];
+                 /*@
+                   @ loop assigns c, hash;
+                   @*/
+                 do {
+                         hash = (hash ^ (unsigned char) *c) * UINT64_C(0x100000001b3);
+                 } while (*c++);
+         }
+         return hash;
+}
+
+/// \cond clam_internal
+/*
+ * Returns the offset of the strings of a snapshot
+ */
+/*@
+  @ assigns \nothing;
+  @*/
+CLAM_API size_t
+         clam__snapshot_strings(
+           size_t events,
+           size_t positionals
+         )
+{
+         size_t size = sizeof(clam_snapshot_header_t) + (3 * events + 2 * positionals) * sizeof(uint32_t) +
+                       events * (sizeof(uint16_t) + sizeof(uint8_t));
+         return size;
+}
+/// \endcond
+
+/**
+ * Writes a snapshot of `record` (whose values are in the `argv` arguments it
+ * refers to) and of the arguments `argv[positionals[k]]` to `output`, if it
+ * fits into `capacity` bytes (`output` should be aligned for `uint64_t`)
+ *
+ * Returns the size of the snapshot, or zero if it would exceed 4 GiB.
+ */
+/*@
+  @ requires \valid_read(record);
+  @ requires \valid_read(positionals + (0 .. npositionals - 1));
+  @ requires \valid((char *) output + (0 .. capacity - 1));
+  @*/
+CLAM_API size_t
+         clam_snapshot_write(
+           const clam_record_t *record,
+           const char *const   *argv,
+           const uint32_t      *positionals,
+           size_t               npositionals,
+           uint64_t             schema,
+           void                *output,
+           size_t               capacity
+         )
+{
+         size_t events = record->count, start = clam__snapshot_strings(events, npositionals), size = start, k;
+         clam_snapshot_header_t *header = (clam_snapshot_header_t *) output;
+         uint32_t *words;
+         char *strings;
+
+         /*@
+           @ loop assigns k, size;
+           @*/
+         for (k = 0; k < events; k++) {
+                 size += record->lengths[k] + 1;
+         }
+         /*@
+           @ loop assigns k, size;
+           @*/
+         for (k = 0; k < npositionals; k++) {
+                 size += strlen(argv[positionals[k]]) + 1;
+         }
+         if (size > UINT32_MAX) {
+                 return 0;
+         }
+         if (size > capacity) {
+                 return size;
+         }
+         memcpy(header->magic, "CLAM", 4);
+         header->version = CLAM_SNAPSHOT_VERSION;
+         header->schema = schema;
+         header->events = (uint32_t) events;
+         header->positionals = (uint32_t) npositionals;
+         header->strings = (uint32_t) (size - start);
+         header->size = (uint32_t) size;
+         words = (uint32_t *) (header + 1);
+         memcpy(words, record->args, events * sizeof(uint32_t));
+         memcpy(words + 2 * events, record->lengths, events * sizeof(uint32_t));
+         memcpy(words + 3 * events + 2 * npositionals, record->ids, events * sizeof(uint16_t));
+         memcpy((char *) (words + 3 * events + 2 * npositionals) + events * sizeof(uint16_t), record->polarities,
+                events);
+         strings = (char *) output + start;
+         size = 0;
+         /*@
+           @ loop assigns k, size, ((char *) output)[0 .. capacity - 1];
+           @*/
+         for (k = 0; k < events; k++) {
+                 memcpy(strings + size, argv[record->args[k]] + record->offsets[k], record->lengths[k]);
+                 strings[size + record->lengths[k]] = 0;
+                 words[events + k] = (uint32_t) size;
+                 size += record->lengths[k] + 1;
+         }
+         /*@
+           @ loop assigns k, size, ((char *) output)[0 .. capacity - 1];
+           @*/
+         for (k = 0; k < npositionals; k++) {
+                 size_t length = strlen(argv[positionals[k]]);
+                 memcpy(strings + size, argv[positionals[k]], length + 1);
+                 words[3 * events + k] = (uint32_t) size;
+                 words[3 * events + npositionals + k] = (uint32_t) length;
+                 size += length + 1;
+         }
+         return header->size;
+}
+
+/**
+ * Opens the snapshot in the `size` bytes at `data` (aligned for
+ * `uint64_t`), which must have been written for the schema with hash
+ * `schema` and `options` option ids
+ *
+ * Returns `CLAM_ERROR_INVALID` if `data` is not a snapshot of this layout
+ * version and schema, any of its strings is out of bounds or any of its
+ * ids is `options` or more; the snapshot is not used then. Snapshots may
+ * come from other processes or from disk, so every id of an opened
+ * snapshot is known to be in range.
+ */
+/*@
+  @ requires \valid(snapshot);
+  @ requires \valid_read((const char *) data + (0 .. size - 1));
+  @ assigns *snapshot;
+  @*/
+CLAM_API clam_error_t
+         clam_snapshot_open(
+           clam_snapshot_t *snapshot,
+           const void      *data,
+           size_t           size,
+           uint64_t         schema,
+           size_t           options
+         )
+{
+         const clam_snapshot_header_t *header = (const clam_snapshot_header_t *) data;
+         const uint32_t *words = (const uint32_t *) (header + 1);
+         size_t events, positionals, start, k;
+         const uint16_t *ids;
+         const uint8_t *polarities;
+         const char *strings;
+
+         if (size < sizeof(*header) || memcmp(header->magic, "CLAM", 4) ||
+             header->version != CLAM_SNAPSHOT_VERSION || header->schema != schema || header->size != size) {
+                 return CLAM_ERROR_INVALID;
+         }
+         events = header->events;
+         positionals = header->positionals;
+         // Each event and positional takes at least one byte of strings
+         if (events + positionals > size ||
+             (start = clam__snapshot_strings(events, positionals)) > size ||
+             size - start != header->strings) {
+                 return CLAM_ERROR_INVALID;
+         }
+         strings = (const char *) data + start;
+         ids = (const uint16_t *) (words + 3 * events + 2 * positionals);
+         polarities = (const uint8_t *) (ids + events);
+         /*@
+           @ loop assigns k;
+           @*/
+         for (k = 0; k < events; k++) {
+                 if (ids[k] >= options || polarities[k] > 1) {
+                         return CLAM_ERROR_INVALID;
+                 }
+         }
+         /*@
+           @ loop assigns k;
+           @*/
+         for (k = 0; k < events + positionals; k++) {
+                 uint32_t offset = k < events ? words[events + k] : words[3 * events + (k - events)];
+                 uint32_t length = k < events ? words[2 * events + k] : words[3 * events + positionals + (k - events)];
+                 if (offset >= header->strings || length >= header->strings - offset || strings[offset + length]) {
+                         return CLAM_ERROR_INVALID;
+                 }
+         }
+         snapshot->schema = schema;
+         snapshot->record.args = (uint32_t *) words;
+         snapshot->record.offsets = (uint32_t *) words + events;
+         snapshot->record.lengths = (uint32_t *) words + 2 * events;
+         snapshot->record.ids = (uint16_t *) ids;
+         snapshot->record.polarities = (uint8_t *) polarities;
+         snapshot->record.count = snapshot->record.capacity = events;
+         snapshot->positional_offsets = words + 3 * events;
+         snapshot->positional_lengths = words + 3 * events + positionals;
+         snapshot->positionals = positionals;
+         snapshot->strings = strings;
+         return CLAM_ERROR_NONE;
+}
+
+/**@}*/
+
+/**
+ * \defgroup hashing Command line hashing
+ *
+ * Canonical hashes of parsed options, for cache keys
+ *
+ * A \ref clam_hash_t is fed the options as they are parsed, by id and value
+ * rather than by spelling, so that equivalent command lines (`-l x`, `-lx`,
+ * `--link=x` and `--link x`) hash the same without a separate
+ * canonicalization pass. Options whose order matters (libraries, include
+ * paths, positionals) are chained in order; all others are combined
+ * commutatively, so that reordering them does not change the hash.
+ *
+ * \code{.c}
+ * clam_hash_t hash;
+ * clam_hash_init(&hash, 0);
+ * // while parsing, with `value` found by whichever spelling was used:
+ * clam_hash_option_ordered(&hash, OPT_LINK, 1, value, strlen(value));
+ * clam_hash_option(&hash, OPT_VERBOSE, 1, NULL, 0);
+ *
+ * uint64_t key[2];
+ * clam_hash_final(&hash, key);
+ * \endcode
+ *
+ * The hash is 128 bits wide and does not depend on the byte order of the
+ * host. It is not cryptographic.
+ *
+ * @{
+ */
+
+/**
+ * Hash being computed, see \ref clam_hash_init
+ */
+typedef struct {
+        uint64_t ordered[2];
+        uint64_t unordered[2];
+        uint64_t count;
+} clam_hash_t;
+
+/// \cond clam_internal
+/*
+ * Multiplies `a` and `b` into 128 bits and returns both halves combined
+ */
+/*@
+  @ assigns \nothing;
+  @*/
+CLAM_API uint64_t
+         clam__mix64(
+           uint64_t a,
+           uint64_t b
+         )
+{
+#if defined(__SIZEOF_INT128__) && !defined(__FRAMAC__)
+         __uint128_t product = (__uint128_t) a * b;
+         return (uint64_t) product ^ (uint64_t) (product >> 64);
+#else
+         uint64_t al = a & 0xffffffff, ah = a >> 32, bl = b & 0xffffffff, bh = b >> 32;
+         uint64_t ll = al * bl, lh = al * bh, hl = ah * bl, hh = ah * bh;
+         uint64_t middle = (ll >> 32) + (lh & 0xffffffff) + (hl & 0xffffffff);
+         uint64_t low = (middle << 32) | (ll & 0xffffffff);
+         uint64_t high = hh + (lh >> 32) + (hl >> 32) + (middle >> 32);
+         return low ^ high;
+#endif
+}
+
+/*
+ * Hashes an option event into two 64-bit lanes
+ */
+/*@
+  @ requires length == 0 || \valid_read(value + (0 .. length - 1));
+  @ requires \valid(lanes + (0 .. 1));
+  @ assigns lanes[0 .. 1];
+  @*/
+CLAM_API void
+         clam__hash_event(
+           uint64_t    seed,
+           int         id,
+           int         polarity,
+           const char *value,
+           size_t      length,
+           uint64_t   *lanes
+         )
+{
+         // The id and polarity seed both lanes and are mixed in again at the
+         // end, as a block can multiply either lane by zero
+         uint64_t key = (uint64_t) (uint32_t) id << 1 | (polarity != 0);
+         uint64_t spread = key * UINT64_C(0x9e3779b97f4a7c15);
+         uint64_t a = seed ^ key ^ UINT64_C(0xa0761d6478bd642f);
+         uint64_t b = seed ^ spread ^ (uint64_t) length ^ UINT64_C(0xe7037ed1a0b428db);
+         size_t i = 0;
+
+         /*@
+           @ loop assigns i, a, b;
+           @*/
+         for (;;) {
+                 uint64_t w0, w1, t;
+                 if (i + 16 <= length) {
+                         w0 = clam__load64le(value + i);
+                         w1 = clam__load64le(value + i + 8);
+                 } else {
+                         char tail[16] = {0};
+                         if (length > i) {
+                                 memcpy(tail, value + i, length - i);
+                         }
+                         w0 = clam__load64le(tail);
+                         w1 = clam__load64le(tail + 8);
+                 }
+                 t = clam__mix64(w0 ^ a ^ UINT64_C(0x8ebc6af09c88c6e3), w1 ^ UINT64_C(0x589965cc75374cc3));
+                 b = clam__mix64(w1 ^ b ^ UINT64_C(0x1d8e4e27c47d124f), w0 ^ UINT64_C(0xa0761d6478bd642f));
+                 a = t;
+                 i += 16;
+                 if (i >= length) {
+                         break;
+                 }
+         }
+         lanes[0] = clam__mix64(a ^ key ^ UINT64_C(0xe7037ed1a0b428db), b ^ spread ^ (uint64_t) length);
+         lanes[1] = clam__mix64(b ^ spread ^ UINT64_C(0x8ebc6af09c88c6e3), lanes[0] ^ a ^ key);
+}
+/// \endcond
+
+/**
+ * Starts an empty hash, with `seed` distinguishing unrelated uses
+ */
+/*@
+  @ requires \valid(hash);
+  @ assigns *hash;
+  @*/
+CLAM_API void
+         clam_hash_init(
+           clam_hash_t *hash,
+           uint64_t     seed
+         )
+{
+         hash->ordered[0] = seed ^ UINT64_C(0x589965cc75374cc3);
+         hash->ordered[1] = seed ^ UINT64_C(0x1d8e4e27c47d124f);
+         hash->unordered[0] = hash->unordered[1] = 0;
+         hash->count = 0;
+}
+
+/**
+ * Adds option `id` with `length` characters of `value` (`NULL` if none) to
+ * `hash`, regardless of its position
+ *
+ * `polarity` is zero for negated forms (`--no-option`).
+ */
+/*@
+  @ requires \valid(hash);
+  @ requires length == 0 || \valid_read(value + (0 .. length - 1));
+  @ assigns *hash;
+  @*/
+CLAM_API void
+         clam_hash_option(
+           clam_hash_t *hash,
+           int          id,
+           int          polarity,
+           const char  *value,
+           size_t       length
+         )
+{
+         uint64_t lanes[2];
+
+         clam__hash_event(0, id, polarity, value, length, lanes);
+         hash->unordered[0] += lanes[0];
+         hash->unordered[1] += lanes[1];
+         hash->count++;
+}
+
+/**
+ * Adds option `id` with `length` characters of `value` to `hash`, after all
+ * options added with this function before
+ *
+ * \see clam_hash_option
+ */
+/*@
+  @ requires \valid(hash);
+  @ requires length == 0 || \valid_read(value + (0 .. length - 1));
+  @ assigns *hash;
+  @*/
+CLAM_API void
+         clam_hash_option_ordered(
+           clam_hash_t *hash,
+           int          id,
+           int          polarity,
+           const char  *value,
+           size_t       length
+         )
+{
+         uint64_t lanes[2], first = hash->ordered[0];
+
+         clam__hash_event(UINT64_C(0x9e3779b97f4a7c15), id, polarity, value, length, lanes);
+         hash->ordered[0] = clam__mix64(first ^ lanes[0], hash->ordered[1] ^ UINT64_C(0xa0761d6478bd642f));
+         hash->ordered[1] = clam__mix64(hash->ordered[1] ^ lanes[1], first ^ UINT64_C(0xe7037ed1a0b428db));
+         hash->count++;
+}
+
+/**
+ * Adds the events of `record` (whose values are in the `argv` arguments it
+ * refers to), chaining those of options in `ordered` and combining all
+ * others commutatively
+ *
+ * Ids of `CLAM_MAX_OPTIONS` or more cannot be in `ordered` and are combined
+ * commutatively.
+ */
+/*@
+  @ requires \valid(hash);
+  @ requires \valid_read(record);
+  @ requires \valid_read(ordered);
+  @ assigns *hash;
+  @*/
+CLAM_API void
+         clam_hash_record(
+           clam_hash_t             *hash,
+           const clam_record_t     *record,
+           const char *const       *argv,
+           const clam_option_set_t *ordered
+         )
+{
+         size_t k;
+
+         /*@
+           @ loop assigns k, *hash;
+           @*/
+         for (k = 0; k < record->count; k++) {
+                 const char *value = argv[record->args[k]] + record->offsets[k];
+                 if (record->ids[k] < CLAM_MAX_OPTIONS && clam_option_set_has(ordered, record->ids[k])) {
+                         clam_hash_option_ordered(hash, record->ids[k], record->polarities[k], value,
+                                                  record->lengths[k]);
+                 } else {
+                         clam_hash_option(hash, record->ids[k], record->polarities[k], value, record->lengths[k]);
+                 }
+         }
+}
+
+/**
+ * Stores the 128-bit hash of the options added to `hash` into `digest`
+ *
+ * `hash` is left unchanged, so more options can be added afterwards.
+ */
+/*@
+  @ requires \valid_read(hash);
+  @ requires \valid(digest + (0 .. 1));
+  @ assigns digest[0 .. 1];
+  @*/
+CLAM_API void
+         clam_hash_final(
+           const clam_hash_t *hash,
+           uint64_t          *digest
+         )
+{
+         uint64_t a = hash->ordered[0] ^ hash->unordered[0], b = hash->ordered[1] ^ hash->unordered[1];
+
+         digest[0] = clam__mix64(a ^ UINT64_C(0x8ebc6af09c88c6e3), b ^ hash->count);
+         digest[1] = clam__mix64(b ^ UINT64_C(0x589965cc75374cc3), digest[0] ^ a);
+}
+
+/**
+ * Stores a 128-bit hash of the raw arguments `argv[0 .. argc - 1]` into
+ * `digest`
+ *
+ * Unlike the hash of parsed options, it changes with any byte of any
+ * argument, but needs no parsing (see \ref cache).
+ */
+/*@
+  @ requires argc >= 0;
+  @ requires \valid_read(argv + (0 .. argc - 1));
+  @ requires \valid(digest + (0 .. 1));
+  @ assigns digest[0 .. 1];
+  @*/
+CLAM_API void
+         clam_hash_argv(
+           int                argc,
+           const char *const *argv,
+           uint64_t          *digest
+         )
+{
+         clam_hash_t hash;
+         int a;
+
+         clam_hash_init(&hash, UINT64_C(0x61726776));
+         /*@
+           @ loop assigns a, hash;
+           @*/
+         for (a = 0; a < argc; a++) {
+                 clam_hash_option_ordered(&hash, 0, 1, argv[a], strlen(argv[a]));
+         }
+         clam_hash_final(&hash, digest);
+}
+
+/**@}*/
+
+#ifdef CLAM_CACHE
+/**
+ * \defgroup cache Parse cache
+ *
+ * Reusing parses of identical command lines across runs (opt-in)
+ *
+ * Defining `CLAM_CACHE` before including `clam.h` enables a cache of \ref
+ * snapshots in a directory, keyed by \ref clam_hash_argv. A tool invoked
+ * over and over with the same command line looks its parse up first and
+ * only runs the matchers (and stores the result) on a miss. It requires
+ * POSIX.1-2008 (`open`, `mmap`, `rename` and `unlinkat`).
+ *
+ * \code{.c}
+ * clam_cache_t cache = {"/var/cache/tool", 1024, 1 << 20, schema, OPTIONS};
+ * uint64_t key[2];
+ * clam_hash_argv(argc, argv, key);
+ *
+ * clam_snapshot_t snapshot;
+ * clam_cache_entry_t entry;
+ * if (clam_cache_lookup(&cache, key, &snapshot, &entry) == CLAM_ERROR_NONE) {
+ *   // use `snapshot`
+ *   clam_cache_release(&entry);
+ * } else {
+ *   // parse into `record`, then:
+ *   clam_cache_store(&cache, key, &record, argv, positionals, npositionals);
+ * }
+ * \endcode
+ *
+ * The cache is direct-mapped: each key has one slot (a file named after the
+ * slot number) and storing a key replaces whatever was in its slot, so the
+ * cache never holds more than `slots` entries of at most `max_entry` bytes.
+ * Entries are written to a temporary file (`.<slot>.<random>`) and renamed
+ * into place, so readers (which map them) never see a partial entry. A
+ * writer that dies before the rename leaves its temporary file behind; each
+ * store removes those older than `CLAM_CACHE_STALE` seconds, so the cache
+ * only exceeds its bound by the entries being written.
+ *
+ * Files are opened with `O_CLOEXEC` and do not leak into child processes.
+ *
+ * @{
+ */
+
+#ifndef CLAM_CACHE_STALE
+/**
+ * Age in seconds after which a temporary cache file is considered left
+ * behind by a dead writer
+ *
+ * Can be redefined externally.
+ */
+#define CLAM_CACHE_STALE 60
+#endif
+
+/**
+ * Cache configuration
+ */
+typedef struct {
+        /** Existing directory holding the entries */
+        const char *directory;
+        /** Number of entries kept */
+        uint32_t    slots;
+        /** Size of the largest snapshot stored */
+        size_t      max_entry;
+        /** Schema hash of the snapshots, see \ref clam_schema_hash */
+        uint64_t    schema;
+        /** Number of option ids of the schema */
+        size_t      options;
+} clam_cache_t;
+
+/**
+ * Mapped cache entry, see \ref clam_cache_lookup
+ */
+typedef struct {
+        void  *mapping;
+        size_t size;
+} clam_cache_entry_t;
+
+/// \cond clam_internal
+/*
+ * Formats the path of the slot of `key`, or of a temporary file for it if
+ * `suffix` is not `NULL`
+ */
+/*@
+  @ requires \valid_read(cache);
+  @ requires \valid_read(key + (0 .. 1));
+  @ requires \valid(path + (0 .. capacity - 1));
+  @*/
+CLAM_API int
+         clam__cache_path(
+           const clam_cache_t *cache,
+           const uint64_t     *key,
+           const uint64_t     *suffix,
+           char               *path,
+           size_t              capacity
+         )
+{
+         unsigned slot = (unsigned) (key[0] % (cache->slots ? cache->slots : 1));
+         int n = suffix ? snprintf(path, capacity, "%s/.%08x.%016llx", cache->directory, slot,
+                                   (unsigned long long) *suffix)
+                        : snprintf(path, capacity, "%s/%08x", cache->directory, slot);
+         return n > 0 && (size_t) n < capacity;
+}
+
+/*
+ * Removes temporary files older than `CLAM_CACHE_STALE` seconds from the
+ * cache directory
+ */
+/*@
+  @ requires \valid_read(cache);
+  @*/
+CLAM_API void
+         clam__cache_sweep(
+           const clam_cache_t *cache
+         )
+{
+         DIR *dir = opendir(cache->directory);
+         struct dirent *dirent;
+         struct stat st;
+         time_t now = time(NULL);
+
+         if (!dir) {
+                 return;
+         }
+         while ((dirent = readdir(dir))) {
+                 const char *name = dirent->d_name;
+                 // `.<slot>.<random>`, as formatted by clam__cache_path
+                 if (name[0] == '.' && strlen(name) == 1 + 8 + 1 + 16 && name[9] == '.' &&
+                     !fstatat(dirfd(dir), name, &st, AT_SYMLINK_NOFOLLOW) && S_ISREG(st.st_mode) &&
+                     now - st.st_mtime > CLAM_CACHE_STALE) {
+                         unlinkat(dirfd(dir), name, 0);
+                 }
+         }
+         closedir(dir);
+}
+/// \endcond
+
+/**
+ * Looks up the snapshot stored for `key`, mapping it into memory
+ *
+ * Returns `CLAM_ERROR_INVALID` if there is none (or it was written for
+ * another schema or is damaged). Otherwise, `*snapshot` refers to the
+ * mapping in `*entry` until \ref clam_cache_release.
+ */
+/*@
+  @ requires \valid_read(cache);
+  @ requires \valid_read(key + (0 .. 1));
+  @ requires \valid(snapshot) && \valid(entry);
+  @*/
+CLAM_API clam_error_t
+         clam_cache_lookup(
+           const clam_cache_t *cache,
+           const uint64_t     *key,
+           clam_snapshot_t    *snapshot,
+           clam_cache_entry_t *entry
+         )
+{
+         char path[4096];
+         struct stat st;
+         void *mapping;
+         int fd;
+
+         entry->mapping = NULL;
+         entry->size = 0;
+         if (!clam__cache_path(cache, key, NULL, path, sizeof(path)) || (fd = open(path, O_RDONLY | O_CLOEXEC)) < 0) {
+                 return CLAM_ERROR_INVALID;
+         }
+         if (fstat(fd, &st) || st.st_size < (off_t) (2 * sizeof(uint64_t) + sizeof(clam_snapshot_header_t)) ||
+             (uint64_t) st.st_size > cache->max_entry + 2 * sizeof(uint64_t)) {
+                 close(fd);
+                 return CLAM_ERROR_INVALID;
+         }
+         mapping = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+         close(fd);
+         if (mapping == MAP_FAILED) {
+                 return CLAM_ERROR_INVALID;
+         }
+         // The key precedes the snapshot, keeping it aligned
+         if (memcmp(mapping, key, 2 * sizeof(uint64_t)) ||
+             clam_snapshot_open(snapshot, (const uint64_t *) mapping + 2, (size_t) st.st_size - 2 * sizeof(uint64_t),
+                                cache->schema, cache->options) != CLAM_ERROR_NONE) {
+                 munmap(mapping, (size_t) st.st_size);
+                 return CLAM_ERROR_INVALID;
+         }
+         entry->mapping = mapping;
+         entry->size = (size_t) st.st_size;
+         return CLAM_ERROR_NONE;
+}
+
+/**
+ * Unmaps an entry found by \ref clam_cache_lookup
+ */
+/*@
+  @ requires \valid(entry);
+  @ assigns entry->mapping;
+  @*/
+CLAM_API void
+         clam_cache_release(
+           clam_cache_entry_t *entry
+         )
+{
+         if (entry->mapping) {
+                 munmap(entry->mapping, entry->size);
+                 entry->mapping = NULL;
+         }
+}
+
+/**
+ * Stores a snapshot of `record` and positionals (see \ref
+ * clam_snapshot_write) for `key`, replacing the entry in its slot
+ *
+ * Returns `CLAM_ERROR_CAPACITY` if the snapshot is larger than
+ * `max_entry`, or `CLAM_ERROR_INVALID` if it could not be written (for
+ * example, when the file system is full).
+ */
+/*@
+  @ requires \valid_read(cache);
+  @ requires \valid_read(key + (0 .. 1));
+  @ requires \valid_read(record);
+  @ requires \valid_read(positionals + (0 .. npositionals - 1));
+  @*/
+CLAM_API clam_error_t
+         clam_cache_store(
+           const clam_cache_t  *cache,
+           const uint64_t      *key,
+           const clam_record_t *record,
+           const char *const   *argv,
+           const uint32_t      *positionals,
+           size_t               npositionals
+         )
+{
+         char path[4096], temporary[4096];
+         size_t size = clam_snapshot_write(record, argv, positionals, npositionals, cache->schema, NULL, 0), written;
+         uint64_t *buffer, suffix;
+         unsigned attempt;
+         ssize_t n;
+         int fd = -1;
+
+         if (!size || size > cache->max_entry) {
+                 return CLAM_ERROR_CAPACITY;
+         }
+         size += 2 * sizeof(uint64_t);
+         if (!clam__cache_path(cache, key, NULL, path, sizeof(path))) {
+                 return CLAM_ERROR_INVALID;
+         }
+         // Written through a mapping, a full file system would raise SIGBUS
+         // instead of failing a write, so the entry is built in memory first
+         if (!(buffer = (uint64_t *) malloc(size))) {
+                 return CLAM_ERROR_CAPACITY;
+         }
+         memcpy(buffer, key, 2 * sizeof(uint64_t));
+         clam_snapshot_write(record, argv, positionals, npositionals, cache->schema, buffer + 2,
+                             size - 2 * sizeof(uint64_t));
+         clam__cache_sweep(cache);
+         /*@
+           @ loop assigns attempt, suffix, temporary[0 .. 4095], fd;
+           @*/
+         for (attempt = 0; fd < 0 && attempt < 16; attempt++) {
+                 suffix = clam__mix64((uint64_t) getpid() << 32 ^ (uint64_t) (uintptr_t) &suffix ^ key[1],
+                                      (uint64_t) time(NULL) ^ attempt ^ UINT64_C(0x9e3779b97f4a7c15));
+                 if (!clam__cache_path(cache, key, &suffix, temporary, sizeof(temporary))) {
+                         break;
+                 }
+                 fd = open(temporary, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+                 if (fd < 0 && errno != EEXIST) {
+                         break;
+                 }
+         }
+         if (fd < 0) {
+                 free(buffer);
+                 return CLAM_ERROR_INVALID;
+         }
+         /*@
+           @ loop assigns written, n;
+           @*/
+         for (written = 0; written < size; written += (size_t) n) {
+                 if ((n = write(fd, (const char *) buffer + written, size - written)) < 0) {
+                         if (errno != EINTR) {
+                                 break;
+                         }
+                         n = 0;
+                 }
+         }
+         free(buffer);
+         if (close(fd) || written < size || rename(temporary, path)) {
+                 unlink(temporary);
+                 return CLAM_ERROR_INVALID;
+         }
+         return CLAM_ERROR_NONE;
+}
+
+/**@}*/
+#endif // CLAM_CACHE
+
+/**
+ * \defgroup incremental Incremental parsing
+ *
+ * Re-parsing only what an edit to the command line affects
+ *
+ * Parsing is split into steps: a \ref clam_parse_step_t parses the argument
+ * at a given index (with any values it binds) and records its events. A
+ * \ref clam_incremental_t remembers where each step started and how many
+ * arguments it consumed, so that after `argv` entries are replaced, inserted
+ * or removed, \ref clam_incremental_update re-runs steps from the one
+ * before the edit only until they line up with the old steps again, and
+ * keeps the events of all other steps.
+ *
+ * \code{.c}
+ * static size_t step(void *context, const char *const *argv, size_t argc, size_t a, clam_record_t *record) {
+ *   clam_match_result_t i;
+ *   if ((i = clam_match_posix_long_option(argv[a], "-link"))) {
+ *     if (a + 1 < argc) {
+ *       clam_record_add(record, OPT_LINK, a + 1, 0, strlen(argv[a + 1]), 1);
+ *       return 2;
+ *     }
+ *   }
+ *   // ...
+ *   return 1;
+ * }
+ *
+ * clam_incremental_t parser;
+ * clam_incremental_init(&parser, step, NULL, &record, spans, capacity);
+ * clam_incremental_parse(&parser, argv, argc);
+ * // argv[5] edited:
+ * clam_incremental_update(&parser, argv, argc, 5, 1, 1);
+ * \endcode
+ *
+ * Steps must behave like the matchers they are built from: their result
+ * may only depend on the arguments they consume and the one after them
+ * (and on whether those exist), and their events must refer to the
+ * arguments they consume.
+ *
+ * @{
+ */
+
+/**
+ * Parses `argv[a]` (and any values it binds), adding its events to
+ * `record`, and returns the number of arguments consumed (at least one)
+ */
+typedef size_t (*clam_parse_step_t)(void *context, const char *const *argv, size_t argc, size_t a,
+                                    clam_record_t *record);
+
+/**
+ * Incremental parser, see \ref clam_incremental_init
+ */
+typedef struct {
+        clam_parse_step_t step;
+        void             *context;
+        /** Events of all steps, ordered by argument */
+        clam_record_t    *record;
+        /**
+         * Number of arguments consumed by the step starting at each
+         * argument, zero for arguments consumed by an earlier step
+         */
+        uint32_t         *spans;
+        size_t            capacity;
+        size_t            argc;
+        /** Number of arguments the last parse or update ran steps for */
+        size_t            reparsed;
+} clam_incremental_t;
+
+/**
+ * Initializes `parser` to run `step` (with `context`) into `record`, for up
+ * to `capacity` arguments (the size of `spans`)
+ */
+/*@
+  @ requires \valid(parser);
+  @ requires \valid(record);
+  @ requires \valid(spans + (0 .. capacity - 1));
+  @ assigns *parser, record->count;
+  @*/
+CLAM_API void
+         clam_incremental_init(
+           clam_incremental_t *parser,
+           clam_parse_step_t   step,
+           void               *context,
+           clam_record_t      *record,
+           uint32_t           *spans,
+           size_t              capacity
+         )
+{
+         parser->step = step;
+         parser->context = context;
+         parser->record = record;
+         parser->spans = spans;
+         parser->capacity = capacity;
+         parser->argc = 0;
+         parser->reparsed = 0;
+         record->count = 0;
+}
+
+/// \cond clam_internal
+/*@
+  @ requires \valid(parser);
+  @ requires \valid_read(argv + (0 .. argc - 1));
+  @*/
+CLAM_API clam_error_t
+         clam__incremental_update(
+           clam_incremental_t *parser,
+           const char *const  *argv,
+           size_t              argc,
+           size_t              first,
+           size_t              removed,
+           size_t              inserted
+         )
+{
+         clam_record_t *record = parser->record;
+         size_t capacity = record->capacity, old = parser->argc, start, p, p_old, low, high, tail, moved, k;
+         uint32_t *spans = parser->spans, *old_spans;
+
+         if (first > old || removed > old - first || argc != old - removed + inserted) {
+                 return CLAM_ERROR_INVALID;
+         }
+         if (argc > parser->capacity) {
+                 return CLAM_ERROR_CAPACITY;
+         }
+         // The step before the edit may have bound (or looked at) it
+         start = first > 0 ? first - 1 : 0;
+         /*@
+           @ loop assigns start;
+           @*/
+         while (start > 0 && !spans[start]) {
+                 start--;
+         }
+         /*@
+           @ loop assigns low, high;
+           @*/
+         for (low = 0, high = record->count; low < high;) {
+                 size_t middle = low + (high - low) / 2;
+                 if (record->args[middle] < start) {
+                         low = middle + 1;
+                 } else {
+                         high = middle;
+                 }
+         }
+         // Old steps from `start` on are moved to the end of the storage,
+         // to be reused once new steps line up with them again
+         tail = record->count - low;
+         moved = capacity - tail;
+         memmove(record->args + moved, record->args + low, tail * sizeof(uint32_t));
+         memmove(record->offsets + moved, record->offsets + low, tail * sizeof(uint32_t));
+         memmove(record->lengths + moved, record->lengths + low, tail * sizeof(uint32_t));
+         memmove(record->ids + moved, record->ids + low, tail * sizeof(uint16_t));
+         memmove(record->polarities + moved, record->polarities + low, tail);
+         old_spans = spans + parser->capacity - (old - start);
+         memmove(old_spans, spans + start, (old - start) * sizeof(uint32_t));
+         record->count = low;
+         p = start;
+         /*@
+           @ loop assigns p, p_old, moved, k, spans[0 .. parser->capacity - 1], *record;
+           @*/
+         for (;;) {
+                 size_t n;
+                 int edited = p < first + inserted;
+                 p_old = edited ? first + removed : p - inserted + removed;
+                 if (!edited && (p == argc || old_spans[p_old - start])) {
+                         break;
+                 }
+                 // Old events before `p_old` are no longer needed, and the
+                 // new ones may take their place (all but one slot, so
+                 // that running out of room shows)
+                 /*@
+                   @ loop assigns moved;
+                   @*/
+                 while (moved < capacity && record->args[moved] < p_old) {
+                         moved++;
+                 }
+                 record->capacity = moved;
+                 n = parser->step(parser->context, argv, argc, p, record);
+                 record->capacity = capacity;
+                 if (record->count == moved) {
+                         return CLAM_ERROR_CAPACITY;
+                 }
+                 n = n == 0 ? 1 : n > argc - p ? argc - p : n;
+                 spans[p] = (uint32_t) n;
+                 /*@
+                   @ loop assigns k, spans[p + 1 .. p + n - 1];
+                   @*/
+                 for (k = 1; k < n; k++) {
+                         spans[p + k] = 0;
+                 }
+                 p += n;
+         }
+         parser->reparsed = p - start;
+         // Keep the old steps from where the new ones line up
+         /*@
+           @ loop assigns moved;
+           @*/
+         while (moved < capacity && record->args[moved] < p_old) {
+                 moved++;
+         }
+         tail = capacity - moved;
+         memmove(spans + p, old_spans + (p_old - start), (old - p_old) * sizeof(uint32_t));
+         memmove(record->args + record->count, record->args + moved, tail * sizeof(uint32_t));
+         memmove(record->offsets + record->count, record->offsets + moved, tail * sizeof(uint32_t));
+         memmove(record->lengths + record->count, record->lengths + moved, tail * sizeof(uint32_t));
+         memmove(record->ids + record->count, record->ids + moved, tail * sizeof(uint16_t));
+         memmove(record->polarities + record->count, record->polarities + moved, tail);
+         /*@
+           @ loop assigns k, record->args[record->count .. record->count + tail - 1];
+           @*/
+         for (k = 0; k < tail; k++) {
+                 record->args[record->count + k] += (uint32_t) (inserted - removed);
+         }
+         record->count += tail;
+         parser->argc = argc;
+         return CLAM_ERROR_NONE;
+}
+/// \endcond
+
+/**
+ * Updates `parser` after `removed` arguments at index `first` were replaced
+ * by `inserted` ones, giving the `argc` arguments `argv`
+ *
+ * Returns `CLAM_ERROR_INVALID` if the edit does not match the previous
+ * number of arguments, or `CLAM_ERROR_CAPACITY` if there are more
+ * arguments than `spans` hold or more events than fit into the record
+ * (which always keeps one slot free); in both cases, everything is
+ * discarded and a full \ref clam_incremental_parse is needed.
+ */
+/*@
+  @ requires \valid(parser);
+  @ requires \valid_read(argv + (0 .. argc - 1));
+  @*/
+CLAM_API clam_error_t
+         clam_incremental_update(
+           clam_incremental_t *parser,
+           const char *const  *argv,
+           size_t              argc,
+           size_t              first,
+           size_t              removed,
+           size_t              inserted
+         )
+{
+         clam_error_t error = clam__incremental_update(parser, argv, argc, first, removed, inserted);
+
+         if (error != CLAM_ERROR_NONE) {
+                 parser->argc = 0;
+                 parser->record->count = 0;
+         }
+         return error;
+}
+
+/**
+ * Parses all `argc` arguments of `argv` from scratch
+ *
+ * \see clam_incremental_update
+ */
+/*@
+  @ requires \valid(parser);
+  @ requires \valid_read(argv + (0 .. argc - 1));
+  @*/
+CLAM_API clam_error_t
+         clam_incremental_parse(
+           clam_incremental_t *parser,
+           const char *const  *argv,
+           size_t              argc
+         )
+{
+         parser->argc = 0;
+         parser->record->count = 0;
+         return clam_incremental_update(parser, argv, argc, 0, 0, argc);
+}
+
+/**@}*/
+
+/**
+ * \defgroup push Push parsing
+ *
+ * Parsing arguments while they arrive
+ *
+ * Arguments received over time (say, through a socket, each terminated by a
+ * null character as in `/proc/self/cmdline`) can be parsed as they come in
+ * rather than after the whole command line is buffered: each chunk is
+ * passed to \ref clam_push_feed in whatever fragments it arrived in, and
+ * every argument is handed to a \ref clam_push_argument_t as soon as its
+ * terminator is seen.
+ *
+ * \code{.c}
+ * static size_t argument(void *context, const char *arg, size_t length, size_t index, clam_push_kind_t kind) {
+ *   if (kind == CLAM_PUSH_ARGUMENT && clam_match_posix_long_option(arg, "-link")) {
+ *     return 1; // `--link` binds the next argument
+ *   }
+ *   // ...
+ *   return 0;
+ * }
+ *
+ * char buffer[4096];
+ * clam_push_t parser;
+ * clam_push_init(&parser, argument, NULL, buffer, sizeof(buffer));
+ * while ((n = recv(socket, chunk, sizeof(chunk), 0)) > 0) {
+ *   if (clam_push_feed(&parser, chunk, n) != CLAM_ERROR_NONE) break;
+ * }
+ * clam_push_finish(&parser);
+ * \endcode
+ *
+ * Values still to be bound and whether options were terminated by `--` are
+ * kept between calls. Arguments that lie within one chunk are passed
+ * without copying; only an argument split across chunks is collected in
+ * the caller-provided buffer.
+ *
+ * @{
+ */
+
+/**
+ * Role of an argument passed to a \ref clam_push_argument_t
+ */
+typedef enum {
+        /** An option or operand before `--` */
+        CLAM_PUSH_ARGUMENT,
+        /** A value bound by an earlier option */
+        CLAM_PUSH_VALUE,
+        /** An operand after `--` */
+        CLAM_PUSH_OPERAND,
+} clam_push_kind_t;
+
+/**
+ * Handles the null-terminated `argument` of `length` bytes at `index` in
+ * the command line, and returns the number of following arguments it binds
+ * as values (only used for `CLAM_PUSH_ARGUMENT`)
+ *
+ * `argument` is only valid during the call.
+ */
+typedef size_t (*clam_push_argument_t)(void *context, const char *argument, size_t length, size_t index,
+                                       clam_push_kind_t kind);
+
+/**
+ * Push parser, see \ref clam_push_init
+ */
+typedef struct {
+        clam_push_argument_t argument;
+        void                *context;
+        /** Bytes of an argument split across chunks */
+        char                *buffer;
+        size_t               capacity;
+        size_t               length;
+        /** Number of complete arguments */
+        size_t               index;
+        /** Number of following arguments still to be bound as values */
+        size_t               pending;
+        /** Whether `--` was seen */
+        uint8_t              terminated;
+} clam_push_t;
+
+/**
+ * Initializes `parser` to pass arguments to `argument` (with `context`),
+ * collecting arguments split across chunks in `buffer` of `capacity` bytes
+ *
+ * `buffer` must hold the longest argument that may be split, with its
+ * terminator.
+ */
+/*@
+  @ requires \valid(parser);
+  @ requires \valid(buffer + (0 .. capacity - 1));
+  @ assigns *parser;
+  @*/
+CLAM_API void
+         clam_push_init(
+           clam_push_t         *parser,
+           clam_push_argument_t argument,
+           void                *context,
+           char                *buffer,
+           size_t               capacity
+         )
+{
+         parser->argument = argument;
+         parser->context = context;
+         parser->buffer = buffer;
+         parser->capacity = capacity;
+         parser->length = 0;
+         parser->index = 0;
+         parser->pending = 0;
+         parser->terminated = 0;
+}
+
+/// \cond clam_internal
+/*@
+  @ requires \valid(parser);
+  @ requires valid_read_string(argument);
+  @*/
+CLAM_API void
+         clam__push_argument(
+           clam_push_t *parser,
+           const char  *argument,
+           size_t       length
+         )
+{
+         if (parser->pending) {
+                 parser->pending--;
+                 parser->argument(parser->context, argument, length, parser->index, CLAM_PUSH_VALUE);
+         } else if (parser->terminated) {
+                 parser->argument(parser->context, argument, length, parser->index, CLAM_PUSH_OPERAND);
+         } else if (clam_match_posix_terminate_options(argument)) {
+                 parser->terminated = 1;
+         } else {
+                 parser->pending = parser->argument(parser->context, argument, length, parser->index,
+                                                    CLAM_PUSH_ARGUMENT);
+         }
+         parser->index++;
+}
+/// \endcond
+
+/**
+ * Feeds the next `size` bytes of the command line to `parser`, passing on
+ * every argument they complete
+ *
+ * `--` itself is not passed on, but counts towards the indices. Returns
+ * `CLAM_ERROR_CAPACITY` if an argument split across chunks does not fit
+ * into the buffer; the arguments before it have been passed on, and
+ * `parser` has to be initialized again.
+ */
+/*@
+  @ requires \valid(parser);
+  @ requires \valid_read(data + (0 .. size - 1));
+  @*/
+CLAM_API clam_error_t
+         clam_push_feed(
+           clam_push_t *parser,
+           const char  *data,
+           size_t       size
+         )
+{
+         const char *end = data + size, *terminator;
+
+         /*@
+           @ loop assigns data, terminator, *parser, parser->buffer[0 .. parser->capacity - 1];
+           @*/
+         while ((terminator = (const char *) memchr(data, '\0', (size_t) (end - data))) != NULL) {
+                 size_t n = (size_t) (terminator - data);
+                 if (parser->length == 0) {
+                         // The whole argument is in this chunk
+                         clam__push_argument(parser, data, n);
+                 } else {
+                         if (n >= parser->capacity - parser->length) {
+                                 return CLAM_ERROR_CAPACITY;
+                         }
+                         memcpy(parser->buffer + parser->length, data, n);
+                         n += parser->length;
+                         parser->buffer[n] = '\0';
+                         parser->length = 0;
+                         clam__push_argument(parser, parser->buffer, n);
+                 }
+                 data = terminator + 1;
+         }
+         if (data < end) {
+                 size_t n = (size_t) (end - data);
+                 if (n >= parser->capacity - parser->length) {
+                         return CLAM_ERROR_CAPACITY;
+                 }
+                 memcpy(parser->buffer + parser->length, data, n);
+                 parser->length += n;
+         }
+         return CLAM_ERROR_NONE;
+}
+
+/**
+ * Ends the command line fed to `parser`, passing on a last argument that
+ * was not terminated
+ *
+ * Returns `CLAM_ERROR_INVALID` if values are still to be bound.
+ */
+/*@
+  @ requires \valid(parser);
+  @*/
+CLAM_API clam_error_t
+         clam_push_finish(
+           clam_push_t *parser
+         )
+{
+         if (parser->length > 0 && clam_push_feed(parser, "", 1) != CLAM_ERROR_NONE) {
+                 return CLAM_ERROR_CAPACITY;
+         }
+         return parser->pending ? CLAM_ERROR_INVALID : CLAM_ERROR_NONE;
+}
+
 /**@}*/
 
 #endif // CLAM_H
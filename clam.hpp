@@ -0,0 +1,1039 @@
+/**
+ * \page cpp C++
+ *
+ * `clam.hpp` is an optional C++20 companion to `clam.h`. It includes the C
+ * header (all C matchers remain available) and adds compile-time option
+ * schemas and matcher combinators (see \ref cpp-combinators) on top of
+ * them.
+ *
+ * ### Option schemas
+ *
+ * An option schema maps option names to an `enum` of option ids. It is built
+ * entirely at compile time (`consteval`) into a perfect hash table, so it
+ * lives in `.rodata` and costs nothing at startup. Lookups hash the name
+ * once, compare the literal length and then the bytes of a single candidate.
+ *
+ * \code{.cpp}
+ * #define OPTIONS(X) \
+ *         X(help, "-help") \
+ *         X(link, "-link") \
+ *         X(link_short, "l")
+ *
+ * CLAM_SCHEMA(option, options, OPTIONS);
+ *
+ * for (int a = 1; a < argc; a++) {
+ *   if (auto m = options.match_posix_long_option(argv[a])) {
+ *     switch (m.id) {
+ *       case option::help: ...
+ *     }
+ *   }
+ * }
+ * \endcode
+ *
+ * If the names can not be dispatched without collisions (or contain
+ * duplicates), the schema fails to compile.
+ *
+ * ### Multi-call binaries
+ *
+ * A schema of applet names selects the applet of a busybox-style binary from
+ * the base name of `argv[0]`; each applet then parses the rest of `argv` as
+ * usual. Only the chosen applet's code runs.
+ *
+ * \code{.cpp}
+ * #define APPLETS(X) X(ls, "ls") X(cat, "cat") X(true_, "true")
+ *
+ * CLAM_SCHEMA(applet, applets, APPLETS);
+ *
+ * static int (*const mains[])(int, char **) = {ls_main, cat_main, true_main};
+ *
+ * int main(int argc, char **argv) {
+ *   if (auto m = applets.match_basename(argv[0])) {
+ *     return mains[static_cast<std::size_t>(m.id)](argc, argv);
+ *   }
+ *   return 127;
+ * }
+ * \endcode
+ */
+
+#ifndef CLAM_HPP
+#define CLAM_HPP
+
+#if __cplusplus < 202002L
+#error "clam.hpp requires C++20"
+#endif
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#ifndef restrict
+#define restrict __restrict
+#define CLAM_HPP_RESTRICT
+#endif
+
+#include "clam.h"
+
+#ifdef CLAM_HPP_RESTRICT
+#undef restrict
+#undef CLAM_HPP_RESTRICT
+#endif
+
+namespace clam {
+
+/**
+ * \defgroup cpp-schema Option schemas (C++)
+ *
+ * Compile-time option name dispatch
+ *
+ * @{
+ */
+
+/**
+ * Option schema entry: option id and its name
+ */
+template <typename Id>
+struct option {
+        Id               id;
+        std::string_view name;
+};
+
+/**
+ * Result of matching `input` against a schema
+ *
+ * `length` follows \ref clam_match_result_t convention: it is zero if nothing
+ * was matched (in which case `id` is meaningless).
+ */
+template <typename Id>
+struct match {
+        Id                  id;
+        clam_match_result_t length;
+
+        constexpr explicit operator bool() const
+        {
+                return length != 0;
+        }
+};
+
+namespace detail {
+
+constexpr std::uint64_t
+hash(std::string_view name)
+{
+        std::uint64_t h = 0xcbf29ce484222325ull ^ name.size();
+        for (char c : name) {
+                h ^= static_cast<unsigned char>(c);
+                h *= 0x100000001b3ull;
+        }
+        return h;
+}
+
+constexpr std::uint64_t
+displace(std::uint64_t h, std::uint32_t displacement)
+{
+        h ^= displacement * 0x9e3779b97f4a7c15ull;
+        h ^= h >> 29;
+        h *= 0xbf58476d1ce4e5b9ull;
+        h ^= h >> 32;
+        return h;
+}
+
+constexpr std::size_t
+ceil_pow2(std::size_t n)
+{
+        std::size_t p = 1;
+        while (p < n) {
+                p <<= 1;
+        }
+        return p;
+}
+
+template <std::size_t N>
+using index_t = std::conditional_t<(N < 0xffff), std::uint16_t, std::uint32_t>;
+
+} // namespace detail
+
+/**
+ * Compile-time option schema over `N` options identified by `Id`
+ *
+ * `Id` is normally an `enum` (or `enum class`) whose values are `0..N-1`.
+ * Schemas are constructed with \ref make_schema or \ref CLAM_SCHEMA.
+ *
+ * The dispatch table is a two-level (hash and displace) perfect hash: the
+ * name hash selects a bucket, the bucket's displacement selects the slot.
+ */
+template <typename Id, std::size_t N>
+class schema {
+        static_assert(N > 0, "schema must have at least one option");
+
+public:
+        /// Number of options in the schema
+        static constexpr std::size_t size = N;
+
+        consteval schema(const option<Id> (&options)[N])
+        {
+                for (std::size_t i = 0; i < N; i++) {
+                        auto id = static_cast<std::size_t>(options[i].id);
+                        if (id >= N) {
+                                throw "option id is out of range (ids must be 0..N-1)";
+                        }
+                        if (!names_[id].empty()) {
+                                throw "option id is used more than once";
+                        }
+                        if (options[i].name.empty()) {
+                                throw "option name is empty";
+                        }
+                        names_[id] = options[i].name;
+                }
+                build();
+        }
+
+        consteval schema(const std::string_view (&names)[N])
+        {
+                for (std::size_t i = 0; i < N; i++) {
+                        if (names[i].empty()) {
+                                throw "option name is empty";
+                        }
+                        names_[i] = names[i];
+                }
+                build();
+        }
+
+        /**
+         * Looks up option id by its exact `name`
+         */
+        constexpr std::optional<Id>
+        find(std::string_view name) const
+        {
+                std::uint64_t h = detail::hash(name);
+                auto index = slots_[slot(h)];
+                if (index == 0) {
+                        return std::nullopt;
+                }
+                std::string_view candidate = names_[index - 1];
+                if (candidate.size() != name.size() ||
+                    !equal(candidate.data(), name.data(), name.size())) {
+                        return std::nullopt;
+                }
+                return static_cast<Id>(index - 1);
+        }
+
+        /**
+         * Returns a hash of the schema's names, equal to \ref
+         * clam_schema_hash of the names in id order (see \ref snapshots)
+         */
+        constexpr std::uint64_t
+        hash() const
+        {
+                std::uint64_t h = 0xcbf29ce484222325ull;
+                for (std::string_view name : names_) {
+                        for (char c : name) {
+                                h = (h ^ static_cast<unsigned char>(c)) * 0x100000001b3ull;
+                        }
+                        h *= 0x100000001b3ull;
+                }
+                return h;
+        }
+
+        /**
+         * Returns the name of the option identified by `id`
+         */
+        constexpr std::string_view
+        name(Id id) const
+        {
+                return names_[static_cast<std::size_t>(id)];
+        }
+
+        /**
+         * Matches `input` if it is a dash (`-`) followed by one of the
+         * schema's names, terminated by either the end of the string or `=`.
+         *
+         * Unlike \ref clam_match_posix_long_option, the name must match in
+         * full (`--hellop` does not match `-hello`).
+         */
+        match<Id>
+        match_posix_long_option(const char *input) const
+        {
+                return match_prefixed(input, clam_match_char(input, '-'));
+        }
+
+        /// \copydoc match_posix_long_option(const char *) const
+        constexpr match<Id>
+        match_posix_long_option(std::string_view input) const
+        {
+                return match_prefixed(input, input.starts_with('-'));
+        }
+
+        /**
+         * Matches `input` if its base name (what follows the last `/`, see
+         * \ref clam_match_dirname_n) is one of the schema's names, such as
+         * the `argv[0]` of a multi-call binary
+         *
+         * The whole of `input` is matched.
+         */
+        match<Id>
+        match_basename(const char *input) const
+        {
+                return match_basename(std::string_view(input));
+        }
+
+        /// \copydoc match_basename(const char *) const
+        constexpr match<Id>
+        match_basename(std::string_view input) const
+        {
+                std::size_t dir;
+                if (std::is_constant_evaluated()) {
+                        dir = input.rfind('/') + 1;
+                } else {
+                        dir = clam_match_dirname_n(input.data(), input.size());
+                }
+                if (auto id = find(input.substr(dir))) {
+                        return {*id, input.size()};
+                }
+                return {Id{}, 0};
+        }
+
+        /**
+         * Matches `input` if it is a forward slash (`/`) followed by one of
+         * the schema's names, terminated by either the end of the string or
+         * `=`.
+         */
+        match<Id>
+        match_windows_long_switch(const char *input) const
+        {
+                return match_prefixed(input, clam_match_char(input, '/'));
+        }
+
+        /// \copydoc match_windows_long_switch(const char *) const
+        constexpr match<Id>
+        match_windows_long_switch(std::string_view input) const
+        {
+                return match_prefixed(input, input.starts_with('/'));
+        }
+
+private:
+        using index_t = detail::index_t<N>;
+
+        static constexpr std::size_t table_size  = detail::ceil_pow2(N) * 2;
+        static constexpr std::size_t bucket_size = detail::ceil_pow2((N + 1) / 2);
+
+        std::array<std::string_view, N>           names_{};
+        std::array<index_t, table_size>           slots_{};
+        std::array<std::uint16_t, bucket_size>    displacements_{};
+
+        constexpr std::size_t
+        slot(std::uint64_t h) const
+        {
+                return detail::displace(h, displacements_[h & (bucket_size - 1)]) &
+                       (table_size - 1);
+        }
+
+        static constexpr bool
+        equal(const char *a, const char *b, std::size_t n)
+        {
+                if (std::is_constant_evaluated()) {
+                        for (std::size_t i = 0; i < n; i++) {
+                                if (a[i] != b[i]) {
+                                        return false;
+                                }
+                        }
+                        return true;
+                }
+                return std::memcmp(a, b, n) == 0;
+        }
+
+        constexpr match<Id>
+        match_prefixed(std::string_view input, clam_match_result_t prefix) const
+        {
+                if (!prefix) {
+                        return {Id{}, 0};
+                }
+                std::string_view name = input.substr(prefix);
+                name = name.substr(0, name.find('='));
+                if (auto id = find(name)) {
+                        return {*id, prefix + name.size()};
+                }
+                return {Id{}, 0};
+        }
+
+        match<Id>
+        match_prefixed(const char *input, clam_match_result_t prefix) const
+        {
+                if (!prefix) {
+                        return {Id{}, 0};
+                }
+                std::size_t length = std::strcspn(input + prefix, "=");
+                if (auto id = find(std::string_view(input + prefix, length))) {
+                        return {*id, prefix + length};
+                }
+                return {Id{}, 0};
+        }
+
+        consteval void
+        build()
+        {
+                std::array<std::uint64_t, N> hashes{};
+                for (std::size_t i = 0; i < N; i++) {
+                        for (std::size_t j = i + 1; j < N; j++) {
+                                if (names_[i] == names_[j]) {
+                                        throw "option name is used more than once";
+                                }
+                        }
+                        hashes[i] = detail::hash(names_[i]);
+                }
+
+                // Place the largest buckets first, they are the hardest to fit
+                std::array<std::size_t, bucket_size> counts{};
+                for (std::size_t i = 0; i < N; i++) {
+                        counts[hashes[i] & (bucket_size - 1)]++;
+                }
+                std::array<bool, table_size> taken{};
+                for (std::size_t count = N; count > 0; count--) {
+                        for (std::size_t b = 0; b < bucket_size; b++) {
+                                if (counts[b] == count) {
+                                        place(b, hashes, taken);
+                                }
+                        }
+                }
+
+                for (std::size_t i = 0; i < N; i++) {
+                        auto id = find(names_[i]);
+                        if (!id || static_cast<std::size_t>(*id) != i) {
+                                throw "schema dispatch is not collision-free";
+                        }
+                }
+        }
+
+        consteval void
+        place(std::size_t bucket, const std::array<std::uint64_t, N> &hashes,
+              std::array<bool, table_size> &taken)
+        {
+                std::array<std::size_t, N> members{};
+                std::size_t count = 0;
+                for (std::size_t i = 0; i < N; i++) {
+                        if ((hashes[i] & (bucket_size - 1)) == bucket) {
+                                members[count++] = i;
+                        }
+                }
+
+                std::array<std::size_t, N> placed{};
+                for (std::uint32_t d = 0; d <= 0xffff; d++) {
+                        std::size_t k = 0;
+                        for (; k < count; k++) {
+                                std::size_t s = detail::displace(hashes[members[k]], d) &
+                                                (table_size - 1);
+                                bool clash = taken[s];
+                                for (std::size_t j = 0; !clash && j < k; j++) {
+                                        clash = placed[j] == s;
+                                }
+                                if (clash) {
+                                        break;
+                                }
+                                placed[k] = s;
+                        }
+                        if (k == count) {
+                                displacements_[bucket] = static_cast<std::uint16_t>(d);
+                                for (k = 0; k < count; k++) {
+                                        taken[placed[k]] = true;
+                                        slots_[placed[k]] = static_cast<index_t>(members[k] + 1);
+                                }
+                                return;
+                        }
+                }
+                throw "no collision-free displacement found for the schema";
+        }
+};
+
+/**
+ * Constructs a schema from `{id, name}` pairs
+ *
+ * \code{.cpp}
+ * enum class opt { help, link };
+ * constexpr auto options = clam::make_schema<opt>({{opt::help, "-help"}, {opt::link, "-link"}});
+ * \endcode
+ */
+template <typename Id, std::size_t N>
+consteval schema<Id, N>
+make_schema(const option<Id> (&options)[N])
+{
+        return schema<Id, N>(options);
+}
+
+/**
+ * Constructs a schema from names; the id of each option is its index
+ */
+template <typename Id, std::size_t N>
+consteval schema<Id, N>
+make_schema(const std::string_view (&names)[N])
+{
+        return schema<Id, N>(names);
+}
+
+/**@}*/
+
+/**
+ * \defgroup cpp-combinators Matcher combinators (C++)
+ *
+ * Composing matchers without hand-written `||`/`&&` chains
+ *
+ * Combinators build parsers out of literals and `clam_match_*` primitives:
+ *
+ * \code{.cpp}
+ * using namespace clam;
+ * std::string_view value;
+ * auto link = seq(alt(lit<"--link">, lit<"-link">, lit<"-l">),
+ *                 opt(lit<"=">), capture(many(alnum), value), end);
+ * if (clam_match_result_t i = link(arg)) { ... }
+ * \endcode
+ *
+ * Each combinator is a distinct type (an expression template), so a parser
+ * compiles to straight-line code without virtual dispatch or allocation.
+ * While the expression is being built:
+ *
+ * \li adjacent literals in a sequence are fused into a single literal
+ *     (`seq(lit<"-">, lit<"-link">)` is `lit<"--link">`);
+ * \li prefixes shared by adjacent alternatives are hoisted out of the
+ *     alternation (`alt(lit<"--link">, lit<"-l">)` is
+ *     `seq(lit<"-">, alt(lit<"-link">, lit<"l">))`).
+ *
+ * Alternation is ordered (first alternative that matches wins) and
+ * repetition is greedy, so these rewrites never change what is matched.
+ *
+ * Calling a parser returns \ref clam_match_result_t. Since a parser may
+ * successfully match nothing (`opt`, `many`), `parse` member functions report
+ * failure as \ref clam::no_match instead.
+ *
+ * @{
+ */
+
+/**
+ * Failure result of parsers' `parse` member function
+ */
+inline constexpr clam_match_result_t no_match = ~static_cast<clam_match_result_t>(0);
+
+/**
+ * String literal usable as a template argument
+ */
+template <std::size_t N>
+struct fixed_string {
+        char chars[N + 1] = {};
+
+        static constexpr std::size_t size = N;
+
+        consteval fixed_string() = default;
+
+        consteval fixed_string(const char (&s)[N + 1])
+        {
+                for (std::size_t i = 0; i < N; i++) {
+                        chars[i] = s[i];
+                }
+        }
+
+        constexpr std::string_view
+        view() const
+        {
+                return {chars, N};
+        }
+};
+
+template <std::size_t N>
+fixed_string(const char (&)[N]) -> fixed_string<N - 1>;
+
+/**
+ * Base of all parsers: makes them callable like `clam_match_*` functions
+ */
+template <typename Parser>
+struct parser {
+        constexpr clam_match_result_t
+        operator()(const char *input) const
+        {
+                clam_match_result_t n = static_cast<const Parser &>(*this).parse(input);
+                return n == no_match ? 0 : n;
+        }
+};
+
+/**
+ * Matches literal `S`
+ */
+template <fixed_string S>
+struct literal : parser<literal<S>> {
+        static constexpr auto string = S;
+
+        constexpr clam_match_result_t
+        parse(const char *input) const
+        {
+                // Short-circuiting stops at the first mismatch, including the
+                // input's null terminator (`S` has none).
+                return [&]<std::size_t... I>(std::index_sequence<I...>) {
+                        return ((input[I] == S.chars[I]) && ...) ? S.size : no_match;
+                }(std::make_index_sequence<S.size>{});
+        }
+};
+
+/**
+ * Matches whatever `clam_match_result_t F(const char *)` matches
+ */
+template <auto F>
+struct primitive : parser<primitive<F>> {
+        constexpr clam_match_result_t
+        parse(const char *input) const
+        {
+                clam_match_result_t n = F(input);
+                return n ? n : no_match;
+        }
+};
+
+/**
+ * Matches one character out of `S` (see \ref clam_match_anychar)
+ */
+template <fixed_string S>
+struct anychar : parser<anychar<S>> {
+        constexpr clam_match_result_t
+        parse(const char *input) const
+        {
+                return clam_match_anychar(input, S.chars) ? 1 : no_match;
+        }
+};
+
+/**
+ * Matches the end of the input without consuming anything
+ */
+struct end_t : parser<end_t> {
+        constexpr clam_match_result_t
+        parse(const char *input) const
+        {
+                return input[0] == '\0' ? 0 : no_match;
+        }
+};
+
+/**
+ * Matches all `Ps` one after another
+ */
+template <typename... Ps>
+struct sequence : parser<sequence<Ps...>> {
+        [[no_unique_address]] std::tuple<Ps...> parsers;
+
+        constexpr sequence(std::tuple<Ps...> ps) : parsers(ps) {}
+
+        constexpr clam_match_result_t
+        parse(const char *input) const
+        {
+                clam_match_result_t n = 0;
+                bool matched = std::apply([&](const Ps &...p) {
+                        return ([&](const auto &q) {
+                                clam_match_result_t r = q.parse(input + n);
+                                n += r;
+                                return r != no_match;
+                        }(p) && ...);
+                }, parsers);
+                return matched ? n : no_match;
+        }
+};
+
+/**
+ * Matches the first of `Ps` that matches
+ */
+template <typename... Ps>
+struct alternative : parser<alternative<Ps...>> {
+        [[no_unique_address]] std::tuple<Ps...> parsers;
+
+        constexpr alternative(std::tuple<Ps...> ps) : parsers(ps) {}
+
+        constexpr clam_match_result_t
+        parse(const char *input) const
+        {
+                clam_match_result_t n = no_match;
+                std::apply([&](const Ps &...p) {
+                        return (((n = p.parse(input)) != no_match) || ...);
+                }, parsers);
+                return n;
+        }
+};
+
+/**
+ * Matches `P` or nothing
+ */
+template <typename P>
+struct optional : parser<optional<P>> {
+        [[no_unique_address]] P p;
+
+        constexpr optional(P p) : p(p) {}
+
+        constexpr clam_match_result_t
+        parse(const char *input) const
+        {
+                clam_match_result_t n = p.parse(input);
+                return n == no_match ? 0 : n;
+        }
+};
+
+/**
+ * Matches `P` as many times as possible (including none)
+ */
+template <typename P>
+struct repetition : parser<repetition<P>> {
+        [[no_unique_address]] P p;
+
+        constexpr repetition(P p) : p(p) {}
+
+        constexpr clam_match_result_t
+        parse(const char *input) const
+        {
+                clam_match_result_t n = 0, r;
+                while ((r = p.parse(input + n)) != no_match && r > 0) {
+                        n += r;
+                }
+                return n;
+        }
+};
+
+/**
+ * Matches `P` and stores the matched part of the input in `*out`
+ */
+template <typename P>
+struct capturing : parser<capturing<P>> {
+        [[no_unique_address]] P p;
+        std::string_view *out;
+
+        constexpr capturing(P p, std::string_view *out) : p(p), out(out) {}
+
+        constexpr clam_match_result_t
+        parse(const char *input) const
+        {
+                clam_match_result_t n = p.parse(input);
+                if (n != no_match) {
+                        *out = std::string_view(input, n);
+                }
+                return n;
+        }
+};
+
+/// Literal `S`
+template <fixed_string S>
+inline constexpr literal<S> lit{};
+
+/// One character out of `S`
+template <fixed_string S>
+inline constexpr anychar<S> any_of{};
+
+/// Any unary `clam_match_*` function (or a lambda with the same signature)
+template <auto F>
+inline constexpr primitive<F> fn{};
+
+/// \see clam_match_numeric10_char
+inline constexpr primitive<clam_match_numeric10_char> digit{};
+/// \see clam_match_numeric16_char
+inline constexpr primitive<clam_match_numeric16_char> hex_digit{};
+/// \see clam_match_uppercase_char
+inline constexpr primitive<clam_match_uppercase_char> upper{};
+/// \see clam_match_lowercase_char
+inline constexpr primitive<clam_match_lowercase_char> lower{};
+/// \see clam_match_alpha_char
+inline constexpr primitive<clam_match_alpha_char> alpha{};
+/// \see clam_match_alphanumeric_char
+inline constexpr primitive<clam_match_alphanumeric_char> alnum{};
+/// \see clam_match_unsigned_integer10
+inline constexpr primitive<clam_match_unsigned_integer10> unsigned_integer10{};
+/// \see clam_match_signed_integer10
+inline constexpr primitive<clam_match_signed_integer10> signed_integer10{};
+/// End of the input
+inline constexpr end_t end{};
+
+namespace detail {
+
+template <typename P>
+struct is_literal : std::false_type {};
+template <fixed_string S>
+struct is_literal<literal<S>> : std::true_type {};
+
+template <typename P>
+struct is_empty_literal : std::false_type {};
+template <fixed_string S>
+        requires(S.size == 0)
+struct is_empty_literal<literal<S>> : std::true_type {};
+
+template <typename Tuple>
+struct ends_with_literal : std::false_type {};
+template <typename... Ts>
+        requires(sizeof...(Ts) > 0)
+struct ends_with_literal<std::tuple<Ts...>>
+        : is_literal<std::tuple_element_t<sizeof...(Ts) - 1, std::tuple<Ts...>>> {};
+
+template <typename P>
+struct is_alternative : std::false_type {};
+template <typename... Ps>
+struct is_alternative<alternative<Ps...>> : std::true_type {};
+
+// Leading literal of a parser (empty if it does not start with one)
+template <typename P>
+struct lead {
+        static constexpr fixed_string<0> string{};
+};
+template <fixed_string S>
+struct lead<literal<S>> {
+        static constexpr auto string = S;
+};
+template <fixed_string S, typename... Ps>
+struct lead<sequence<literal<S>, Ps...>> {
+        static constexpr auto string = S;
+};
+
+template <typename X, typename Y>
+consteval std::size_t
+common_prefix()
+{
+        std::string_view x = lead<X>::string.view(), y = lead<Y>::string.view();
+        std::size_t k = 0;
+        while (k < x.size() && k < y.size() && x[k] == y[k]) {
+                k++;
+        }
+        return k;
+}
+
+template <fixed_string S, std::size_t From, std::size_t Length>
+consteval fixed_string<Length>
+substr()
+{
+        fixed_string<Length> result;
+        for (std::size_t i = 0; i < Length; i++) {
+                result.chars[i] = S.chars[From + i];
+        }
+        return result;
+}
+
+template <fixed_string A, fixed_string B>
+consteval fixed_string<A.size + B.size>
+concat()
+{
+        fixed_string<A.size + B.size> result;
+        for (std::size_t i = 0; i < A.size; i++) {
+                result.chars[i] = A.chars[i];
+        }
+        for (std::size_t i = 0; i < B.size; i++) {
+                result.chars[A.size + i] = B.chars[i];
+        }
+        return result;
+}
+
+template <typename Tuple, std::size_t... I>
+constexpr auto
+select(const Tuple &t, std::index_sequence<I...>)
+{
+        return std::tuple<std::tuple_element_t<I, Tuple>...>(std::get<I>(t)...);
+}
+
+template <std::size_t From, typename... Ts>
+constexpr auto
+drop_front(const std::tuple<Ts...> &t)
+{
+        return [&]<std::size_t... I>(std::index_sequence<I...>) {
+                return select(t, std::index_sequence<(From + I)...>{});
+        }(std::make_index_sequence<sizeof...(Ts) - From>{});
+}
+
+template <typename... Ts>
+constexpr auto
+drop_back(const std::tuple<Ts...> &t)
+{
+        return select(t, std::make_index_sequence<sizeof...(Ts) - 1>{});
+}
+
+template <typename P>
+constexpr auto
+elements(const P &p)
+{
+        return std::tuple<P>(p);
+}
+
+template <typename... Ps>
+constexpr auto
+elements(const sequence<Ps...> &s)
+{
+        return s.parsers;
+}
+
+// Appends `q` to a sequence of parsers, fusing adjacent literals
+template <typename... Ts, typename Q>
+constexpr auto
+append(const std::tuple<Ts...> &t, const Q &q)
+{
+        if constexpr (is_empty_literal<Q>::value) {
+                return t;
+        } else if constexpr (is_literal<Q>::value && ends_with_literal<std::tuple<Ts...>>::value) {
+                using Last = std::tuple_element_t<sizeof...(Ts) - 1, std::tuple<Ts...>>;
+                return std::tuple_cat(drop_back(t),
+                                      std::tuple<literal<concat<Last::string, Q::string>()>>());
+        } else {
+                return std::tuple_cat(t, std::tuple<Q>(q));
+        }
+}
+
+template <typename... Ts>
+constexpr auto
+append_all(const std::tuple<Ts...> &t)
+{
+        return t;
+}
+
+template <typename... Ts, typename... Qs, typename... Rest>
+constexpr auto
+append_all(const std::tuple<Ts...> &t, const std::tuple<Qs...> &qs, const Rest &...rest)
+{
+        if constexpr (sizeof...(Qs) == 0) {
+                return append_all(t, rest...);
+        } else {
+                return append_all(append(t, std::get<0>(qs)), drop_front<1>(qs), rest...);
+        }
+}
+
+template <typename... Ts>
+constexpr auto
+make_sequence(const std::tuple<Ts...> &t)
+{
+        if constexpr (sizeof...(Ts) == 0) {
+                return literal<fixed_string<0>{}>();
+        } else if constexpr (sizeof...(Ts) == 1) {
+                return std::get<0>(t);
+        } else {
+                return sequence<Ts...>(t);
+        }
+}
+
+template <typename... Ps>
+constexpr auto
+make_seq(const Ps &...ps)
+{
+        return make_sequence(append_all(std::tuple<>(), elements(ps)...));
+}
+
+// Removes the first `K` characters of the parser's leading literal
+template <std::size_t K, typename P>
+constexpr auto
+drop_lead(const P &p)
+{
+        constexpr auto s = lead<P>::string;
+        using rest = literal<substr<s, K, s.size - K>()>;
+        if constexpr (is_literal<P>::value) {
+                return rest();
+        } else {
+                return make_sequence(append_all(std::tuple<>(), std::tuple<rest>(),
+                                                drop_front<1>(p.parsers)));
+        }
+}
+
+template <typename X, typename Y>
+constexpr auto
+make_alt2(const X &x, const Y &y)
+{
+        constexpr std::size_t k = common_prefix<X, Y>();
+        if constexpr (k > 0) {
+                using prefix = literal<substr<lead<X>::string, 0, k>()>;
+                return make_seq(prefix(), make_alt2(drop_lead<k>(x), drop_lead<k>(y)));
+        } else if constexpr (is_alternative<Y>::value) {
+                using Y0 = std::tuple_element_t<0, decltype(y.parsers)>;
+                if constexpr (common_prefix<X, Y0>() > 0) {
+                        auto first = make_alt2(x, std::get<0>(y.parsers));
+                        return alternative(std::tuple_cat(std::tuple(first),
+                                                          drop_front<1>(y.parsers)));
+                } else {
+                        return alternative(std::tuple_cat(std::tuple<X>(x), y.parsers));
+                }
+        } else {
+                return alternative<X, Y>(std::tuple<X, Y>(x, y));
+        }
+}
+
+template <typename P, typename... Ps>
+constexpr auto
+make_alt(const P &p, const Ps &...ps)
+{
+        if constexpr (sizeof...(Ps) == 0) {
+                return p;
+        } else {
+                return make_alt2(p, make_alt(ps...));
+        }
+}
+
+} // namespace detail
+
+/**
+ * Matches all `ps` one after another
+ */
+template <typename... Ps>
+constexpr auto
+seq(const parser<Ps> &...ps)
+{
+        return detail::make_seq(static_cast<const Ps &>(ps)...);
+}
+
+/**
+ * Matches the first of `ps` that matches
+ */
+template <typename P, typename... Ps>
+constexpr auto
+alt(const parser<P> &p, const parser<Ps> &...ps)
+{
+        return detail::make_alt(static_cast<const P &>(p), static_cast<const Ps &>(ps)...);
+}
+
+/**
+ * Matches `p` or nothing
+ */
+template <typename P>
+constexpr auto
+opt(const parser<P> &p)
+{
+        return optional<P>(static_cast<const P &>(p));
+}
+
+/**
+ * Matches `p` as many times as possible (including none)
+ */
+template <typename P>
+constexpr auto
+many(const parser<P> &p)
+{
+        return repetition<P>(static_cast<const P &>(p));
+}
+
+/**
+ * Matches `p` and stores the matched part of the input in `out`
+ */
+template <typename P>
+constexpr auto
+capture(const parser<P> &p, std::string_view &out)
+{
+        return capturing<P>(static_cast<const P &>(p), &out);
+}
+
+/**@}*/
+
+} // namespace clam
+
+/// \cond
+#define CLAM__SCHEMA_ID(id, name) id,
+#define CLAM__SCHEMA_NAME(id, name) name,
+/// \endcond
+
+/**
+ * Declares `enum class Id` and `constexpr` schema `var` from a single list
+ *
+ * `list` is an X-macro taking a macro of two arguments: option id
+ * (enumerator) and option name.
+ *
+ * \code{.cpp}
+ * #define OPTIONS(X) X(help, "-help") X(link, "-link")
+ * CLAM_SCHEMA(option, options, OPTIONS);
+ * \endcode
+ */
+#define CLAM_SCHEMA(Id, var, list)                                            \
+        enum class Id { list(CLAM__SCHEMA_ID) };                              \
+        inline constexpr auto var = ::clam::make_schema<Id>({list(CLAM__SCHEMA_NAME)})
+
+#endif // CLAM_HPP
+/** @file */
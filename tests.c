@@ -1,8 +1,19 @@
+#if defined(__unix__) || defined(__APPLE__)
+#define _POSIX_C_SOURCE 200809L
+#define CLAM_CACHE
+#endif
+
+#include <errno.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <stdbool.h>
 
 #include "clam.h"
 
+#if defined(__unix__) || defined(__APPLE__)
+#include <arpa/inet.h>
+#endif
+
 #ifdef QUIET
 #define printf(...)
 #endif
@@ -28,6 +39,75 @@ void enable_positive_asserts() {
         } \
 } 
 
+static size_t link_step(void *context, const char *const *argv, size_t argc, size_t a, clam_record_t *record) {
+        (void) context;
+        if (strcmp(argv[a], "--link") == 0 && a + 1 < argc) {
+                clam_record_add(record, 1, (uint32_t) (a + 1), 0, (uint32_t) strlen(argv[a + 1]), 1);
+                return 2;
+        }
+        clam_record_add(record, argv[a][0] == '-' ? 2 : 0, (uint32_t) a, 0, (uint32_t) strlen(argv[a]), 1);
+        return 1;
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+static unsigned next_random(uint64_t *state, unsigned bound) {
+        *state = *state * 6364136223846793005u + 1442695040888963407u;
+        return (unsigned) (*state >> 33) % bound;
+}
+
+// An address-like string: mostly valid, with stray zeros, long groups,
+// extra colons and out of range numbers
+static void generate_address(char *text, uint64_t *state, int ipv6) {
+        char *p = text;
+        unsigned k, groups;
+        if (!ipv6) {
+                groups = 3 + next_random(state, 3);
+                for (k = 0; k < groups; k++) {
+                        p += sprintf(p, next_random(state, 8) ? "%u" : "0%u",
+                                     next_random(state, 10) ? next_random(state, 256) : next_random(state, 400));
+                        if (k + 1 < groups || !next_random(state, 8)) {
+                                *p++ = '.';
+                        }
+                }
+                *p = 0;
+                return;
+        }
+        groups = next_random(state, 10);
+        for (k = 0; k < groups; k++) {
+                unsigned digits = next_random(state, 8) ? 1 + next_random(state, 4) : next_random(state, 6), d;
+                if (!next_random(state, 6)) {
+                        *p++ = ':';
+                }
+                for (d = 0; d < digits; d++) {
+                        *p++ = "0123456789abcdefABCDEF"[next_random(state, next_random(state, 10) ? 16 : 22)];
+                }
+                if (k + 1 < groups) {
+                        *p++ = ':';
+                }
+        }
+        if (!next_random(state, 4)) {
+                if (p != text) {
+                        *p++ = ':';
+                }
+                p += sprintf(p, "%u.%u.%u.%u", next_random(state, 256), next_random(state, 256),
+                             next_random(state, 300), next_random(state, 256));
+        }
+        if (!next_random(state, 8)) {
+                *p++ = ':';
+                *p++ = ':';
+        }
+        *p = 0;
+}
+#endif
+
+static size_t push_argument(void *context, const char *argument, size_t length, size_t index, clam_push_kind_t kind) {
+        char *log = (char *) context;
+        size_t used = strlen(log);
+        snprintf(log + used, 256 - used, "%zu%c%s%s ", index, "AVO"[kind], argument,
+                 length == strlen(argument) ? "" : "!");
+        return kind == CLAM_PUSH_ARGUMENT && strcmp(argument, "--link") == 0 ? 1 : 0;
+}
+
 int main(int argc, char *argv[])
 {
 
@@ -255,5 +335,1521 @@ int main(int argc, char *argv[])
                 "`clam_match_windows_long_switch` should not match against an empty string");
         }
 
+        {
+            printf("# Runtime patterns\n");
+
+            clam_pattern_node_t nodes[32];
+            clam_pattern_t p;
+            clam_dfa_t dfa;
+            uint16_t table[1024];
+
+            clam_pattern_init(&p, nodes, 32);
+            int define = clam_pattern_sequence(&p,
+                            clam_pattern_literal(&p, "-D"),
+                            clam_pattern_repeat(&p, clam_pattern_class(&p, clam_match_alphanumeric_char),
+                                                1, CLAM_PATTERN_UNBOUNDED));
+            ASSERT(clam_dfa_compile(&dfa, table, 1024, &p, define) == CLAM_ERROR_NONE,
+                "`clam_dfa_compile` should compile a valid pattern");
+            ASSERT(clam_match_dfa("-DFOO1=1", &dfa) == strlen("-DFOO1"),
+                "`clam_match_dfa` should match a sequence with a repetition");
+            ASSERT(!clam_match_dfa("-D=1", &dfa),
+                "`clam_match_dfa` should not match if a required repetition is missing");
+            ASSERT(!clam_match_dfa("-d", &dfa),
+                "`clam_match_dfa` should not match a non-matching literal");
+            ASSERT(!clam_match_dfa("", &dfa),
+                "`clam_match_dfa` should not match an empty string");
+
+            clam_pattern_init(&p, nodes, 32);
+            int link = clam_pattern_sequence(&p,
+                          clam_pattern_alternation(&p,
+                            clam_pattern_alternation(&p,
+                              clam_pattern_literal(&p, "--link"),
+                              clam_pattern_literal(&p, "-link")),
+                            clam_pattern_literal(&p, "-l")),
+                          clam_pattern_repeat(&p, clam_pattern_anychar(&p, "="), 0, 1));
+            ASSERT(clam_dfa_compile(&dfa, table, 1024, &p, link) == CLAM_ERROR_NONE,
+                "`clam_dfa_compile` should compile an alternation");
+            const char *inputs[] = {"--link", "--link=", "-link=x", "-l", "-lx", "-li", "--lin", "--l", "-", "x", "--linkage", ""};
+            int agree = 1, i;
+            for (i = 0; i < (int) (sizeof(inputs) / sizeof(inputs[0])); i++) {
+                    clam_match_result_t expected;
+                    if ((expected = clam_match_posix_long_option(inputs[i], "-link")) ||
+                        (expected = clam_match_posix_long_option(inputs[i], "link")) ||
+                        (expected = clam_match_posix_long_option(inputs[i], "l"))) {
+                            expected += clam_match_char(inputs[i] + expected, '=');
+                    }
+                    agree = agree && clam_match_dfa(inputs[i], &dfa) == expected;
+            }
+            ASSERT(agree,
+                "`clam_match_dfa` should match like the equivalent chain of matchers");
+            ASSERT(clam_match_dfa("-li", &dfa) == 2,
+                "`clam_match_dfa` should fall back to the longest accepted prefix");
+
+            clam_pattern_init(&p, nodes, 32);
+            int digits = clam_pattern_repeat(&p, clam_pattern_class(&p, clam_match_numeric10_char), 2, 3);
+            ASSERT(clam_dfa_compile(&dfa, table, 1024, &p, digits) == CLAM_ERROR_NONE,
+                "`clam_dfa_compile` should compile a bounded repetition");
+            ASSERT(clam_match_dfa("12345", &dfa) == 3,
+                "`clam_match_dfa` should match up to the maximum number of repetitions");
+            ASSERT(clam_match_dfa("12a", &dfa) == 2,
+                "`clam_match_dfa` should match the minimum number of repetitions");
+            ASSERT(!clam_match_dfa("1a", &dfa),
+                "`clam_match_dfa` should not match less than the minimum number of repetitions");
+            ASSERT(dfa.nclasses == 2,
+                "`clam_dfa_compile` should compress bytes into classes");
+
+            clam_pattern_init(&p, nodes, 32);
+            int merged = clam_pattern_alternation(&p,
+                            clam_pattern_literal(&p, "ab"),
+                            clam_pattern_literal(&p, "cb"));
+            ASSERT(clam_dfa_compile(&dfa, table, 1024, &p, merged) == CLAM_ERROR_NONE &&
+                   dfa.states == 4,
+                "`clam_dfa_compile` should minimize equivalent states");
+            ASSERT(clam_match_dfa("cb", &dfa) == 2 && clam_match_dfa("ab", &dfa) == 2 &&
+                   !clam_match_dfa("bb", &dfa),
+                "`clam_match_dfa` should match a minimized DFA");
+
+            ASSERT(clam_dfa_compile(&dfa, table, 4, &p, merged) == CLAM_ERROR_CAPACITY,
+                "`clam_dfa_compile` should fail if the table is too small");
+            ASSERT(clam_dfa_compile(&dfa, table, 1024, &p, 100) == CLAM_ERROR_INVALID,
+                "`clam_dfa_compile` should fail on an invalid node");
+            ASSERT(clam_pattern_repeat(&p, merged, 3, 2) == -1,
+                "`clam_pattern_repeat` should not accept a minimum larger than the maximum");
+            clam_pattern_init(&p, nodes, 1);
+            ASSERT(clam_pattern_sequence(&p, clam_pattern_literal(&p, "a"), clam_pattern_literal(&p, "b")) == -1,
+                "`clam_pattern_sequence` should fail if there is no room for nodes");
+        }
+
+        {
+            printf("# Scanning\n");
+
+            const char *flags[] = {"--force", "--force-all", "-Werror", "--no-verify", "-f"};
+            clam_scanner_t scanner;
+            uint16_t table[1024];
+            clam_scan_match_t match;
+            size_t position = 0;
+            int i;
+
+            ASSERT(clam_scanner_init(&scanner, table, 1024, flags, 5) == CLAM_ERROR_NONE,
+                "`clam_scanner_init` should build a scanner");
+
+            const char *log = "-f git commit --no-verify -m 'x' --no-verifyx\n"
+                              "cc -Werror=format -c a.c \"--force-all\" x--force --force";
+            size_t expected[][2] = {{4, 0}, {3, 14}, {2, 49}, {1, 72}, {0, 94}};
+            int found = 0, correct = 1;
+            while (clam_scan_next(&scanner, log, strlen(log), &position, &match)) {
+                    correct = correct && found < 5 && match.pattern == expected[found][0] &&
+                              match.offset == expected[found][1] &&
+                              match.length == strlen(flags[match.pattern]);
+                    found++;
+            }
+            ASSERT(correct && found == 5,
+                "`clam_scan_next` should find all occurrences at token boundaries");
+
+            // Compare with matching every name at every token boundary
+            static char text[65536];
+            const char *words[] = {"--force", "--force-all", "-Werror", "--no-verify", "-f",
+                                   "--forc", "-Werror=x", "--force-all-", "make", "-", ""};
+            const char *separators[] = {" ", "\n", "\t", "=", "'", "x", "  "};
+            size_t len = 0;
+            unsigned seed = 1;
+            while (len < sizeof(text) - 32) {
+                    seed = seed * 1103515245 + 12345;
+                    const char *w = words[(seed >> 16) % 11];
+                    const char *sep = separators[(seed >> 8) % 7];
+                    memcpy(text + len, w, strlen(w));
+                    len += strlen(w);
+                    memcpy(text + len, sep, strlen(sep));
+                    len += strlen(sep);
+            }
+            text[len] = 0;
+
+            int agree = 1, count = 0;
+            position = 0;
+            for (size_t at = 0; at < len; at++) {
+                    size_t best = 0, best_pattern = 0;
+                    if (at > 0 && !strchr(" \t\n\v\f\r\"'", text[at - 1])) {
+                            continue;
+                    }
+                    for (i = 0; i < 5; i++) {
+                            clam_match_result_t n = clam_match_chars(text + at, flags[i]);
+                            if (n > best && strchr(" \t\n\v\f\r\"'=", text[at + n])) {
+                                    best = n;
+                                    best_pattern = i;
+                            }
+                    }
+                    if (best) {
+                            count++;
+                            agree = agree && clam_scan_next(&scanner, text, len, &position, &match) &&
+                                    match.offset == at && match.pattern == best_pattern &&
+                                    match.length == best;
+                    }
+            }
+            agree = agree && !clam_scan_next(&scanner, text, len, &position, &match);
+            ASSERT(agree && count > 1000,
+                "`clam_scan_next` should find the same occurrences as matching at every token boundary");
+
+            const char *empty[] = {"-a", ""};
+            ASSERT(clam_scanner_init(&scanner, table, 1024, empty, 2) == CLAM_ERROR_INVALID,
+                "`clam_scanner_init` should not accept an empty name");
+            ASSERT(clam_scanner_init(&scanner, table, 16, flags, 5) == CLAM_ERROR_CAPACITY,
+                "`clam_scanner_init` should fail if the table is too small");
+            static const char *names[UINT16_MAX];
+            size_t n;
+            for (n = 0; n < UINT16_MAX; n++) {
+                    names[n] = "--flag";
+            }
+            ASSERT(clam_scanner_init(&scanner, table, 1024, names, UINT16_MAX - 1) == CLAM_ERROR_NONE &&
+                   clam_scanner_init(&scanner, table, 1024, names, UINT16_MAX) == CLAM_ERROR_CAPACITY,
+                "`clam_scanner_init` should fail if there are more names than it can index");
+        }
+
+        {
+            printf("# Case-insensitive matching\n");
+
+            ASSERT(clam_match_chars_nocase("HeLLo", "hello") == strlen("hello"),
+                "`clam_match_chars_nocase` should match regardless of case");
+            ASSERT(clam_match_chars_nocase("HELLOworld", "hello") == strlen("hello"),
+                "`clam_match_chars_nocase` should match even if the input is longer");
+            ASSERT(!clam_match_chars_nocase("HELL", "hello"),
+                "`clam_match_chars_nocase` should not match a shorter input");
+            ASSERT(!clam_match_chars_nocase("hello", ""),
+                "`clam_match_chars_nocase` should not match an empty string");
+            ASSERT(!clam_match_chars_nocase("@[\\]^", "`{|}~"),
+                "`clam_match_chars_nocase` should only fold letters");
+            ASSERT(clam_match_chars_nocase("A-Very-Long-Option-Name-With-Mixed-Case", "a-very-long-OPTION-name-with-mixed-case") ==
+                   strlen("a-very-long-option-name-with-mixed-case"),
+                "`clam_match_chars_nocase` should match long strings regardless of case");
+            ASSERT(!clam_match_chars_nocase("A-Very-Long-Option-Name-With-Mixed-Case", "a-very-long-OPTION-name-with-mixed-cas@"),
+                "`clam_match_chars_nocase` should not match long non-matching strings");
+            ASSERT(!clam_match_chars_nocase("a-very-long-option-name-With-Mixed-Case", "a-very-long-option-name-with-mixed-c\xc1se"),
+                "`clam_match_chars_nocase` should not fold non-ASCII characters");
+            ASSERT(!clam_match_chars_nocase("\xe1", "\xc1"),
+                "`clam_match_chars_nocase` should not fold non-ASCII characters");
+
+            int all = 1, i;
+            char upper[2] = {0, 0}, lower[2] = {0, 0};
+            for (i = 0; i < 256; i++) {
+                    int j;
+                    for (j = 1; j < 256; j++) {
+                            int same = i == j || (i >= 'A' && i <= 'Z' && j == i + 32) ||
+                                       (j >= 'A' && j <= 'Z' && i == j + 32);
+                            char a[17], b[17];
+                            upper[0] = (char) i;
+                            lower[0] = (char) j;
+                            memset(a, 'x', 16);
+                            memset(b, 'X', 16);
+                            a[7] = a[15] = (char) i;
+                            b[7] = b[15] = (char) j;
+                            a[16] = b[16] = 0;
+                            if (i > 0) {
+                                    all = all && !clam_match_chars_nocase(upper, lower) == !same;
+                            }
+                            all = all && !clam_match_chars_nocase(a, b) == !same;
+                    }
+            }
+            ASSERT(all,
+                "`clam_match_chars_nocase` should fold exactly the ASCII letters");
+
+            ASSERT(clam_match_chars_to_end_nocase("Auto", "auto"),
+                "`clam_match_chars_to_end_nocase` should match a terminated string regardless of case");
+            ASSERT(!clam_match_chars_to_end_nocase("Automatic", "auto"),
+                "`clam_match_chars_to_end_nocase` should not match if the input is longer");
+
+            ASSERT(clam_match_posix_long_option_nocase("--HELP", "-help") == strlen("--HELP"),
+                "`clam_match_posix_long_option_nocase` should match regardless of case");
+            ASSERT(!clam_match_posix_long_option_nocase("-HELP", "-help"),
+                "`clam_match_posix_long_option_nocase` should not match a non-matching string");
+
+            ASSERT(clam_match_windows_switch_nocase("/A", "dacb1") == 2,
+                "`clam_match_windows_switch_nocase` should match an allowed switch regardless of case");
+            ASSERT(!clam_match_windows_switch_nocase("/Z", "dacb1"),
+                "`clam_match_windows_switch_nocase` should not match a switch that is not allowed");
+            ASSERT(clam_match_windows_long_switch_nocase("/NoLogo", "nologo") == strlen("/NoLogo"),
+                "`clam_match_windows_long_switch_nocase` should match regardless of case");
+            ASSERT(!clam_match_windows_long_switch_nocase("/NoLog", "nologo"),
+                "`clam_match_windows_long_switch_nocase` should not match a shorter switch");
+        }
+
+        {
+            printf("# UTF-8\n");
+
+            ASSERT(clam_match_utf8("hello") == strlen("hello"),
+                "`clam_match_utf8` should match ASCII");
+            ASSERT(clam_match_utf8("") == 0,
+                "`clam_match_utf8` should match an empty string");
+            ASSERT(clam_match_utf8("caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80") == strlen("caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80"),
+                "`clam_match_utf8` should match two, three and four byte characters");
+            ASSERT(clam_match_utf8("\xed\x9f\xbf\xee\x80\x80\xf4\x8f\xbf\xbf") == 10,
+                "`clam_match_utf8` should match the characters around surrogates and U+10FFFF");
+            ASSERT(clam_match_utf8("ab\xc0\xaf") == 2,
+                "`clam_match_utf8` should not match an overlong two byte character");
+            ASSERT(clam_match_utf8("ab\xe0\x80\xaf") == 2,
+                "`clam_match_utf8` should not match an overlong three byte character");
+            ASSERT(clam_match_utf8("ab\xf0\x80\x80\xaf") == 2,
+                "`clam_match_utf8` should not match an overlong four byte character");
+            ASSERT(clam_match_utf8("ab\xed\xa0\x80") == 2,
+                "`clam_match_utf8` should not match a surrogate");
+            ASSERT(clam_match_utf8("ab\xf4\x90\x80\x80") == 2,
+                "`clam_match_utf8` should not match a code point above U+10FFFF");
+            ASSERT(clam_match_utf8("ab\xf5\x80\x80\x80") == 2,
+                "`clam_match_utf8` should not match an invalid lead byte");
+            ASSERT(clam_match_utf8("ab\x80") == 2,
+                "`clam_match_utf8` should not match a stray continuation byte");
+            ASSERT(clam_match_utf8("ab\xe2\x82") == 2,
+                "`clam_match_utf8` should not match a truncated character");
+            ASSERT(clam_match_utf8_n("\xe2\x82\xac", 2) == 0,
+                "`clam_match_utf8_n` should not look past the given length");
+            ASSERT(clam_match_utf8_n("a\0b", 3) == 3,
+                "`clam_match_utf8_n` should match NUL characters");
+
+            // Differential test against a straightforward decoder over
+            // random mutations of a long mixed text
+            int agree = 1, i;
+            static const char *pieces[] = {"abcdefgh", "\xc3\xa9", "\xe2\x82\xac", "\xf0\x9f\x98\x80",
+                                           "\xed\x9f\xbf", "\xf4\x8f\xbf\xbf", "0123456789abcdef"};
+            unsigned seed = 7;
+            for (i = 0; i < 4000; i++) {
+                    char text[300];
+                    size_t n = 0, expected = 0, j;
+                    seed = seed * 1103515245 + 12345;
+                    size_t target = (seed >> 16) % 280;
+                    while (n < target) {
+                            seed = seed * 1103515245 + 12345;
+                            const char *p = pieces[(seed >> 16) % 7];
+                            if (n + strlen(p) > target) {
+                                    break;
+                            }
+                            memcpy(text + n, p, strlen(p));
+                            n += strlen(p);
+                    }
+                    if (n > 0 && i % 4) {
+                            seed = seed * 1103515245 + 12345;
+                            text[(seed >> 8) % n] = (char) (seed >> 16);
+                    }
+                    while (expected < n) {
+                            const unsigned char *c = (const unsigned char *) text + expected;
+                            size_t len = c[0] < 0x80 ? 1 : (c[0] & 0xe0) == 0xc0 ? 2 :
+                                         (c[0] & 0xf0) == 0xe0 ? 3 : (c[0] & 0xf8) == 0xf0 ? 4 : 0;
+                            unsigned long cp = len == 1 ? c[0] : len == 2 ? c[0] & 0x1f :
+                                               len == 3 ? c[0] & 0x0f : c[0] & 0x07;
+                            if (len == 0 || expected + len > n) {
+                                    break;
+                            }
+                            for (j = 1; j < len && (c[j] & 0xc0) == 0x80; j++) {
+                                    cp = (cp << 6) | (c[j] & 0x3f);
+                            }
+                            if (j < len || cp > 0x10ffff || (cp >= 0xd800 && cp <= 0xdfff) ||
+                                (len == 2 && cp < 0x80) || (len == 3 && cp < 0x800) ||
+                                (len == 4 && cp < 0x10000)) {
+                                    break;
+                            }
+                            expected += len;
+                    }
+                    agree = agree && clam_match_utf8_n(text, n) == expected;
+            }
+            ASSERT(agree,
+                "`clam_match_utf8_n` should agree with a straightforward decoder");
+        }
+
+        {
+            printf("# Sizes\n");
+
+            uint64_t size = 0;
+            clam_error_t error = CLAM_ERROR_INVALID;
+            ASSERT(clam_match_size("4096", &size, &error) == 4 && size == 4096 && error == CLAM_ERROR_NONE,
+                "`clam_match_size` should match a number of bytes");
+            ASSERT(clam_match_size("64K", &size, NULL) == 3 && size == 64 * 1024,
+                "`clam_match_size` should match a binary unit");
+            ASSERT(clam_match_size("64k", &size, NULL) == 3 && size == 64 * 1024,
+                "`clam_match_size` should match a lowercase unit");
+            ASSERT(clam_match_size("4MiB", &size, NULL) == 4 && size == 4 * 1024 * 1024,
+                "`clam_match_size` should match an IEC unit");
+            ASSERT(clam_match_size("4MB", &size, NULL) == 3 && size == 4000000,
+                "`clam_match_size` should match an SI unit");
+            ASSERT(clam_match_size("1.5G", &size, NULL) == 4 && size == UINT64_C(1610612736),
+                "`clam_match_size` should match a fraction");
+            ASSERT(clam_match_size("0.001K", &size, NULL) == 6 && size == 1,
+                "`clam_match_size` should round fractional bytes down");
+            ASSERT(clam_match_size("512B", &size, NULL) == 4 && size == 512,
+                "`clam_match_size` should match bytes");
+            ASSERT(clam_match_size("16Mi", &size, NULL) == 3 && size == 16 * 1024 * 1024,
+                "`clam_match_size` should not match an incomplete IEC unit");
+            ASSERT(clam_match_size("1.x", &size, NULL) == 1 && size == 1,
+                "`clam_match_size` should not match a dot without a fraction");
+            ASSERT(clam_match_size("15E", &size, NULL) == 3 && size == UINT64_C(15) << 60,
+                "`clam_match_size` should match the largest unit");
+            ASSERT(clam_match_size("18446744073709551615", &size, NULL) == 20 && size == UINT64_MAX,
+                "`clam_match_size` should match the largest size");
+            ASSERT(!clam_match_size("18446744073709551616", &size, &error) && error == CLAM_ERROR_RANGE,
+                "`clam_match_size` should report a number that is too large");
+            ASSERT(!clam_match_size("16E", &size, &error) && error == CLAM_ERROR_RANGE,
+                "`clam_match_size` should report a size that is too large");
+            ASSERT(clam_match_size("18446744073709551.615KB", &size, NULL) == 23 && size == UINT64_MAX,
+                "`clam_match_size` should match the largest size with a fraction");
+            ASSERT(!clam_match_size("18446744073709551.999KB", &size, &error) && error == CLAM_ERROR_RANGE,
+                "`clam_match_size` should report a fraction that makes a size too large");
+            ASSERT(!clam_match_size("K", &size, &error) && error == CLAM_ERROR_INVALID,
+                "`clam_match_size` should not match a unit alone");
+            ASSERT(!clam_match_size(".5K", &size, &error) && error == CLAM_ERROR_INVALID,
+                "`clam_match_size` should not match a fraction alone");
+        }
+
+        {
+            printf("# Durations\n");
+
+            int64_t duration = 0;
+            clam_error_t error = CLAM_ERROR_INVALID;
+            ASSERT(clam_match_duration("250ms", &duration, &error) == 5 && duration == 250000000 && error == CLAM_ERROR_NONE,
+                "`clam_match_duration` should match a duration");
+            ASSERT(clam_match_duration("1h30m", &duration, NULL) == 5 && duration == INT64_C(5400000000000),
+                "`clam_match_duration` should match a compound duration");
+            ASSERT(clam_match_duration("2.5s", &duration, NULL) == 4 && duration == 2500000000,
+                "`clam_match_duration` should match a fraction");
+            ASSERT(clam_match_duration("-1m1.5us", &duration, NULL) == 8 && duration == -INT64_C(60000001500),
+                "`clam_match_duration` should match a negative duration");
+            ASSERT(clam_match_duration("+3ns", &duration, NULL) == 4 && duration == 3,
+                "`clam_match_duration` should match a positive sign");
+            ASSERT(clam_match_duration("10\xc2\xb5s", &duration, NULL) == 5 && duration == 10000,
+                "`clam_match_duration` should match microseconds with a micro sign");
+            ASSERT(clam_match_duration("10\xce\xbcs", &duration, NULL) == 5 && duration == 10000,
+                "`clam_match_duration` should match microseconds with a Greek mu");
+            ASSERT(clam_match_duration("0", &duration, NULL) == 1 && duration == 0,
+                "`clam_match_duration` should match zero without a unit");
+            ASSERT(clam_match_duration("1.0000000001s", &duration, NULL) == 13 && duration == 1000000000,
+                "`clam_match_duration` should round fractional nanoseconds down");
+            ASSERT(clam_match_duration("1h30", &duration, NULL) == 2 && duration == INT64_C(3600000000000),
+                "`clam_match_duration` should not match a number without a unit");
+            ASSERT(clam_match_duration("9223372036854775807ns", &duration, NULL) == 21 && duration == INT64_MAX,
+                "`clam_match_duration` should match the longest duration");
+            ASSERT(clam_match_duration("-9223372036854775808ns", &duration, NULL) == 22 && duration == INT64_MIN,
+                "`clam_match_duration` should match the shortest duration");
+            ASSERT(!clam_match_duration("9223372036854775808ns", &duration, &error) && error == CLAM_ERROR_RANGE,
+                "`clam_match_duration` should report a duration that is too long");
+            ASSERT(!clam_match_duration("2562047h48m", &duration, &error) && error == CLAM_ERROR_RANGE,
+                "`clam_match_duration` should report a compound duration that is too long");
+            ASSERT(!clam_match_duration("10", &duration, &error) && error == CLAM_ERROR_INVALID,
+                "`clam_match_duration` should not match a number without a unit");
+            ASSERT(!clam_match_duration("ms", &duration, &error) && error == CLAM_ERROR_INVALID,
+                "`clam_match_duration` should not match a unit alone");
+        }
+
+        {
+            printf("# Timestamps\n");
+
+            int64_t timestamp = 0;
+            clam_error_t error = CLAM_ERROR_INVALID;
+            ASSERT(clam_match_timestamp("1970-01-01T00:00:00Z", &timestamp, &error) == 20 && timestamp == 0 &&
+                   error == CLAM_ERROR_NONE,
+                "`clam_match_timestamp` should match the epoch");
+            ASSERT(clam_match_timestamp("1985-04-12T23:20:50.52Z", &timestamp, NULL) == 23 &&
+                   timestamp == INT64_C(482196050520000000),
+                "`clam_match_timestamp` should match a fraction");
+            ASSERT(clam_match_timestamp("1996-12-19T16:39:57-08:00", &timestamp, NULL) == 25 &&
+                   timestamp == INT64_C(851042397000000000),
+                "`clam_match_timestamp` should match a negative offset");
+            ASSERT(clam_match_timestamp("2024-02-29 13:45:00,25+0100 and more", &timestamp, NULL) == 27 &&
+                   timestamp == INT64_C(1709210700250000000),
+                "`clam_match_timestamp` should match a space, a comma and an offset without a colon");
+            ASSERT(clam_match_timestamp("1969-12-31t23:59:59.5z", &timestamp, NULL) == 22 &&
+                   timestamp == -500000000,
+                "`clam_match_timestamp` should match a time before the epoch");
+            ASSERT(clam_match_timestamp("1990-12-31T23:59:60Z", &timestamp, NULL) == 20 &&
+                   timestamp == INT64_C(662688000000000000),
+                "`clam_match_timestamp` should match a leap second");
+            ASSERT(clam_match_timestamp("2262-04-11T23:47:16.8547758079Z", &timestamp, NULL) == 31 &&
+                   timestamp == INT64_MAX,
+                "`clam_match_timestamp` should match the latest time");
+            ASSERT(clam_match_timestamp("1677-09-21T00:12:43.145224192Z", &timestamp, NULL) == 30 &&
+                   timestamp == INT64_MIN,
+                "`clam_match_timestamp` should match the earliest time");
+            ASSERT(!clam_match_timestamp("2262-04-11T23:47:16.854775808Z", &timestamp, &error) &&
+                   error == CLAM_ERROR_RANGE,
+                "`clam_match_timestamp` should report a time that is too late");
+            ASSERT(!clam_match_timestamp("1677-09-21T00:12:43.145224191Z", &timestamp, &error) &&
+                   error == CLAM_ERROR_RANGE,
+                "`clam_match_timestamp` should report a time that is too early");
+            ASSERT(!clam_match_timestamp("2023-02-29T00:00:00Z", &timestamp, &error) && error == CLAM_ERROR_INVALID,
+                "`clam_match_timestamp` should not match a day that does not exist");
+            ASSERT(!clam_match_timestamp("2023-13-01T00:00:00Z", &timestamp, NULL),
+                "`clam_match_timestamp` should not match a month that does not exist");
+            ASSERT(!clam_match_timestamp("2023-01-01T24:00:00Z", &timestamp, NULL),
+                "`clam_match_timestamp` should not match an hour that does not exist");
+            ASSERT(!clam_match_timestamp("2023-01-01T00:00:00", &timestamp, NULL),
+                "`clam_match_timestamp` should not match a time without an offset");
+            ASSERT(!clam_match_timestamp("2023-01-01T00:00:00+01:0", &timestamp, NULL),
+                "`clam_match_timestamp` should not match an incomplete offset");
+            ASSERT(!clam_match_timestamp("2023-01-01T00:0a:00Z", &timestamp, NULL),
+                "`clam_match_timestamp` should not match a non-digit");
+            ASSERT(!clam_match_timestamp("2023-01-01", &timestamp, NULL),
+                "`clam_match_timestamp` should not match a date alone");
+
+            // Every day from 1900 to 2100 against a day counter
+            int agree = 1;
+            unsigned year = 1900, month = 1, day = 1;
+            int64_t days = -25567;
+            while (year < 2100) {
+                    char text[32];
+                    sprintf(text, "%04u-%02u-%02uT12:00:00Z", year, month, day);
+                    agree = agree && clam_match_timestamp(text, &timestamp, NULL) == 20 &&
+                            timestamp == (days * 86400 + 43200) * INT64_C(1000000000);
+                    days++;
+                    if (++day > clam__days_in_month(year, month)) {
+                            day = 1;
+                            if (++month > 12) {
+                                    month = 1;
+                                    year++;
+                            }
+                    }
+            }
+            ASSERT(agree,
+                "`clam_match_timestamp` should match every day of the 20th and 21st centuries");
+        }
+
+        {
+            printf("# IP addresses\n");
+
+            uint8_t v4[4] = {0}, v6[16] = {0};
+            unsigned prefix = 0;
+            ASSERT(clam_match_ipv4("192.168.0.1", v4) == 11 && v4[0] == 192 && v4[1] == 168 && v4[2] == 0 && v4[3] == 1,
+                "`clam_match_ipv4` should match an IPv4 address");
+            ASSERT(clam_match_ipv4("255.255.255.255", v4) == 15 && v4[0] == 255 && v4[3] == 255,
+                "`clam_match_ipv4` should match the longest IPv4 address");
+            ASSERT(clam_match_ipv4("0.0.0.0:80", v4) == 7 && v4[0] == 0 && v4[3] == 0,
+                "`clam_match_ipv4` should match an IPv4 address followed by something else");
+            ASSERT(!clam_match_ipv4("256.0.0.1", v4),
+                "`clam_match_ipv4` should not match a number above 255");
+            ASSERT(!clam_match_ipv4("1.2.3.1000", v4),
+                "`clam_match_ipv4` should not match a number with more than three digits");
+            ASSERT(!clam_match_ipv4("01.2.3.4", v4),
+                "`clam_match_ipv4` should not match a number with a leading zero");
+            ASSERT(!clam_match_ipv4("1.2.3", v4) && !clam_match_ipv4("1.2.3.", v4) && !clam_match_ipv4("1..2.3", v4),
+                "`clam_match_ipv4` should not match fewer than four numbers");
+            ASSERT(!clam_match_ipv4("1.2.3.\xca" "4", v4),
+                "`clam_match_ipv4` should not match non-ASCII characters");
+
+            static const uint8_t loopback[16] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1};
+            static const uint8_t documentation[16] = {0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xab, 0xcd};
+            static const uint8_t mapped[16] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff, 192, 168, 0, 1};
+            static const uint8_t full[16] = {0, 1, 0, 2, 0, 3, 0, 4, 0, 5, 0, 6, 0, 7, 0, 8};
+            static const uint8_t trailing[16] = {0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+            ASSERT(clam_match_ipv6("::1", v6) == 3 && !memcmp(v6, loopback, 16),
+                "`clam_match_ipv6` should match a leading `::`");
+            ASSERT(clam_match_ipv6("2001:DB8::abcd", v6) == 14 && !memcmp(v6, documentation, 16),
+                "`clam_match_ipv6` should match a `::` in the middle");
+            ASSERT(clam_match_ipv6("1::", v6) == 3 && !memcmp(v6, trailing, 16),
+                "`clam_match_ipv6` should match a trailing `::`");
+            ASSERT(clam_match_ipv6("::", v6) == 2 && !memcmp(v6, trailing + 2, 14) && v6[14] == 0 && v6[15] == 0,
+                "`clam_match_ipv6` should match `::` alone");
+            ASSERT(clam_match_ipv6("1:2:3:4:5:6:7:8", v6) == 15 && !memcmp(v6, full, 16),
+                "`clam_match_ipv6` should match eight groups");
+            ASSERT(clam_match_ipv6("::ffff:192.168.0.1", v6) == 18 && !memcmp(v6, mapped, 16),
+                "`clam_match_ipv6` should match an embedded IPv4 address");
+            ASSERT(clam_match_ipv6("0:0:0:0:0:ffff:192.168.0.1", v6) == 26 && !memcmp(v6, mapped, 16),
+                "`clam_match_ipv6` should match an embedded IPv4 address without `::`");
+            ASSERT(!clam_match_ipv6("1:2:3:4:5:6:7:8::", v6),
+                "`clam_match_ipv6` should not match `::` replacing no groups");
+            ASSERT(!clam_match_ipv6("1::2::3", v6),
+                "`clam_match_ipv6` should not match two `::`");
+            ASSERT(!clam_match_ipv6("1:2:3:4:5:6:7", v6),
+                "`clam_match_ipv6` should not match seven groups");
+            ASSERT(!clam_match_ipv6("12345::", v6),
+                "`clam_match_ipv6` should not match a group with more than four digits");
+            ASSERT(!clam_match_ipv6(":1::", v6),
+                "`clam_match_ipv6` should not match a single leading colon");
+            ASSERT(!clam_match_ipv6("1:2:3:4:5:6:7:1.2.3.4", v6),
+                "`clam_match_ipv6` should not match an embedded IPv4 address in place of one group");
+
+            ASSERT(clam_match_ipv4_cidr("10.0.0.0/8", v4, &prefix) == 10 && v4[0] == 10 && prefix == 8,
+                "`clam_match_ipv4_cidr` should match an IPv4 network");
+            ASSERT(clam_match_ipv4_cidr("10.0.0.1/32", v4, &prefix) == 11 && prefix == 32,
+                "`clam_match_ipv4_cidr` should match the longest prefix");
+            ASSERT(!clam_match_ipv4_cidr("10.0.0.0/33", v4, &prefix),
+                "`clam_match_ipv4_cidr` should not match a prefix that is too long");
+            ASSERT(!clam_match_ipv4_cidr("10.0.0.0/08", v4, &prefix) && !clam_match_ipv4_cidr("10.0.0.0", v4, &prefix),
+                "`clam_match_ipv4_cidr` should not match an invalid or missing prefix length");
+            ASSERT(clam_match_ipv6_cidr("2001:db8::/32", v6, &prefix) == 13 && v6[1] == 1 && prefix == 32,
+                "`clam_match_ipv6_cidr` should match an IPv6 network");
+            ASSERT(clam_match_ipv6_cidr("::/0", v6, &prefix) == 4 && prefix == 0,
+                "`clam_match_ipv6_cidr` should match an empty prefix");
+            ASSERT(!clam_match_ipv6_cidr("::/129", v6, &prefix),
+                "`clam_match_ipv6_cidr` should not match a prefix that is too long");
+
+            int all = 1, i;
+            for (i = 0; i < 256 * 8; i++) {
+                    char text[20];
+                    unsigned char a = (unsigned char) (i % 256), b = (unsigned char) (255 - a),
+                                  c = (unsigned char) (a * 7 % 256), d = (unsigned char) (i / 8);
+                    snprintf(text, sizeof(text), "%u.%u.%u.%u", a, b, c, d);
+                    all = all && clam_match_ipv4(text, v4) == strlen(text) &&
+                          v4[0] == a && v4[1] == b && v4[2] == c && v4[3] == d;
+            }
+            ASSERT(all,
+                "`clam_match_ipv4` should match addresses with numbers of every length");
+
+#if defined(__unix__) || defined(__APPLE__)
+            uint64_t state = 1;
+            int agree = 1, ipv6;
+            for (i = 0; i < 200000; i++) {
+                    char text[128];
+                    uint8_t ours[16], theirs[16];
+                    size_t length;
+                    int valid;
+                    ipv6 = i & 1;
+                    generate_address(text, &state, ipv6);
+                    length = ipv6 ? clam_match_ipv6(text, ours) : clam_match_ipv4(text, ours);
+                    valid = inet_pton(ipv6 ? AF_INET6 : AF_INET, text, theirs) == 1;
+                    agree = agree && (length && length == strlen(text)) == valid &&
+                            (!valid || !memcmp(ours, theirs, ipv6 ? 16 : 4));
+            }
+            ASSERT(agree,
+                "`clam_match_ipv4` and `clam_match_ipv6` should agree with `inet_pton`");
+#endif
+        }
+
+        {
+            printf("# UUIDs\n");
+
+            static const uint8_t expected[16] = {0x12, 0x3e, 0x45, 0x67, 0xe8, 0x9b, 0x12, 0xd3,
+                                                 0xa4, 0x56, 0x42, 0x66, 0x14, 0x17, 0x40, 0x00};
+            uint8_t uuid[16] = {0};
+            ASSERT(clam_match_uuid("123e4567-e89b-12d3-a456-426614174000", uuid) == 36 && !memcmp(uuid, expected, 16),
+                "`clam_match_uuid` should match a canonical UUID");
+            ASSERT(clam_match_uuid("{123E4567-E89B-12D3-A456-426614174000}", uuid) == 38 && !memcmp(uuid, expected, 16),
+                "`clam_match_uuid` should match a braced uppercase UUID");
+            ASSERT(clam_match_uuid("123e4567e89b12d3a456426614174000,", uuid) == 32 && !memcmp(uuid, expected, 16),
+                "`clam_match_uuid` should match a UUID without hyphens");
+            ASSERT(!clam_match_uuid("123e4567e89b12d3a456426614174000f", uuid),
+                "`clam_match_uuid` should not match more than 32 hexadecimal digits");
+            ASSERT(!clam_match_uuid("123e4567-e89b-12d3-a456-4266141740001", uuid),
+                "`clam_match_uuid` should not match a longer last group");
+            ASSERT(!clam_match_uuid("123e4567-e89b-12d3-a456-42661417400", uuid),
+                "`clam_match_uuid` should not match a shorter UUID");
+            ASSERT(!clam_match_uuid("{123e4567-e89b-12d3-a456-426614174000", uuid),
+                "`clam_match_uuid` should not match a missing closing brace");
+            ASSERT(!clam_match_uuid("{123e4567e89b12d3a456426614174000}", uuid),
+                "`clam_match_uuid` should not match a braced UUID without hyphens");
+            ASSERT(!clam_match_uuid("123e4567-e89b-12d3a456-426614174000", uuid),
+                "`clam_match_uuid` should not match a misplaced hyphen");
+
+            int all = 1, i;
+            const char *canonical = "123e4567-e89b-12d3-a456-426614174000";
+            for (i = 0; i < 36; i++) {
+                    static const char invalid[] = {'g', 'G', '/', ':', '@', '`', '-', ' ', '\xc0'};
+                    size_t k;
+                    for (k = 0; k < sizeof(invalid); k++) {
+                            char text[40];
+                            strcpy(text, canonical);
+                            if (text[i] == '-' && invalid[k] == '-') {
+                                    continue;
+                            }
+                            text[i] = invalid[k];
+                            all = all && !clam_match_uuid(text, uuid);
+                    }
+            }
+            ASSERT(all,
+                "`clam_match_uuid` should not match a non-hexadecimal character in any position");
+        }
+
+        {
+            printf("# Booleans\n");
+
+            static const char *const truthy[] = {"1", "y", "yes", "t", "true", "on", "YES", "True", "oN"};
+            static const char *const falsy[] = {"0", "n", "no", "f", "false", "off", "NO", "False", "OFF"};
+            int all = 1, value = -1;
+            size_t i;
+            for (i = 0; i < sizeof(truthy) / sizeof(truthy[0]); i++) {
+                    value = -1;
+                    all = all && clam_match_boolean(truthy[i], &value) == strlen(truthy[i]) && value == 1;
+                    value = -1;
+                    all = all && clam_match_boolean(falsy[i], &value) == strlen(falsy[i]) && value == 0;
+            }
+            ASSERT(all,
+                "`clam_match_boolean` should match every spelling in any case");
+            ASSERT(clam_match_boolean("off,on", &value) == 3 && value == 0,
+                "`clam_match_boolean` should match a spelling followed by a delimiter");
+            ASSERT(clam_match_boolean("yes=", &value) == 3 && value == 1,
+                "`clam_match_boolean` should match a spelling followed by punctuation");
+            value = -1;
+            ASSERT(!clam_match_boolean("onion", &value) && value == -1,
+                "`clam_match_boolean` should not match a spelling followed by a letter");
+            ASSERT(!clam_match_boolean("10", &value) && !clam_match_boolean("truex", &value) &&
+                   !clam_match_boolean("falsey", &value),
+                "`clam_match_boolean` should not match a longer word");
+            ASSERT(!clam_match_boolean("tru", &value) && !clam_match_boolean("", &value) &&
+                   !clam_match_boolean("maybe", &value),
+                "`clam_match_boolean` should not match other words");
+            ASSERT(!clam_match_boolean("\xd4rue", &value),
+                "`clam_match_boolean` should not fold non-ASCII characters");
+        }
+
+        {
+            printf("# Hex and base64\n");
+
+            uint8_t bytes[256];
+            size_t size = 0;
+            clam_error_t error = CLAM_ERROR_INVALID;
+            ASSERT(clam_match_hex("DEADbeef", bytes, sizeof(bytes), &size, &error) == 8 && size == 4 &&
+                   bytes[0] == 0xde && bytes[3] == 0xef && error == CLAM_ERROR_NONE,
+                "`clam_match_hex` should decode hexadecimal digits");
+            ASSERT(clam_match_hex("00112233445566778899aabbccddeeff0011223344556677x", bytes, sizeof(bytes), &size, NULL) == 48 &&
+                   size == 24 && bytes[16] == 0x00 && bytes[23] == 0x77,
+                "`clam_match_hex` should stop at the first invalid character");
+            ASSERT(clam_match_hex("abc", bytes, sizeof(bytes), &size, NULL) == 2 && size == 1,
+                "`clam_match_hex` should not match an unpaired digit");
+            ASSERT(!clam_match_hex("x", bytes, sizeof(bytes), &size, &error) && error == CLAM_ERROR_INVALID,
+                "`clam_match_hex` should not match without digits");
+            ASSERT(!clam_match_hex("abcd", bytes, 1, &size, &error) && error == CLAM_ERROR_CAPACITY,
+                "`clam_match_hex` should report a buffer that is too small");
+
+            ASSERT(clam_match_base64("SGVsbG8sIHdvcmxkIQ==", CLAM_BASE64_STANDARD, bytes, sizeof(bytes), &size, &error) == 20 &&
+                   size == 13 && !memcmp(bytes, "Hello, world!", 13) && error == CLAM_ERROR_NONE,
+                "`clam_match_base64` should decode padded base64");
+            ASSERT(clam_match_base64("SGVsbG8sIHdvcmxkIQ", CLAM_BASE64_STANDARD, bytes, sizeof(bytes), &size, NULL) == 18 &&
+                   size == 13 && !memcmp(bytes, "Hello, world!", 13),
+                "`clam_match_base64` should decode unpadded base64");
+            ASSERT(clam_match_base64("SGk=,SGk=", CLAM_BASE64_STANDARD, bytes, sizeof(bytes), &size, NULL) == 4 && size == 2,
+                "`clam_match_base64` should end the match after padding");
+            ASSERT(clam_match_base64("-_-_", CLAM_BASE64_URL, bytes, sizeof(bytes), &size, NULL) == 4 && size == 3 &&
+                   bytes[0] == 0xfb && bytes[1] == 0xff && bytes[2] == 0xbf,
+                "`clam_match_base64` should decode the URL alphabet");
+            ASSERT(clam_match_base64("+/+/-_", CLAM_BASE64_STANDARD, bytes, sizeof(bytes), &size, NULL) == 4 && size == 3,
+                "`clam_match_base64` should not decode the URL alphabet as standard");
+            ASSERT(clam_match_base64("QUJDR", CLAM_BASE64_STANDARD, bytes, sizeof(bytes), &size, NULL) == 4 && size == 3,
+                "`clam_match_base64` should not match a character that does not complete a byte");
+            ASSERT(!clam_match_base64("Q", CLAM_BASE64_STANDARD, bytes, sizeof(bytes), &size, &error) && error == CLAM_ERROR_INVALID,
+                "`clam_match_base64` should not match without a complete byte");
+            ASSERT(clam_match_base64("QQ==", CLAM_BASE64_STANDARD, bytes, sizeof(bytes), &size, NULL) == 4 && size == 1 &&
+                   !clam_match_base64("QR==", CLAM_BASE64_STANDARD, bytes, sizeof(bytes), &size, NULL) &&
+                   clam_match_base64("QUI=", CLAM_BASE64_STANDARD, bytes, sizeof(bytes), &size, NULL) == 4 && size == 2 &&
+                   clam_match_base64("QUJDQUJ=", CLAM_BASE64_STANDARD, bytes, sizeof(bytes), &size, NULL) == 4 &&
+                   size == 3,
+                "`clam_match_base64` should not match a last character with bits past the last byte set");
+            ASSERT(!clam_match_base64("QUJD", CLAM_BASE64_STANDARD, bytes, 2, &size, &error) && error == CLAM_ERROR_CAPACITY,
+                "`clam_match_base64` should report a buffer that is too small");
+
+            // Round trips of random data, with an invalid character at a
+            // random position in every other one
+            static const char *const alphabets[2] = {
+                    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/",
+                    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_",
+            };
+            int agree = 1, i;
+            unsigned seed = 11;
+            for (i = 0; i < 2000; i++) {
+                    uint8_t data[180];
+                    char hex[400], base64[260];
+                    size_t n, k, h = 0, b = 0;
+                    int url = i % 2;
+                    seed = seed * 1103515245 + 12345;
+                    n = (seed >> 16) % 180;
+                    for (k = 0; k < n; k++) {
+                            seed = seed * 1103515245 + 12345;
+                            data[k] = (uint8_t) (seed >> 16);
+                            h += (size_t) sprintf(hex + h, k % 3 ? "%02x" : "%02X", data[k]);
+                    }
+                    for (k = 0; k < n; k += 3) {
+                            unsigned w = (unsigned) data[k] << 16 | (k + 1 < n ? (unsigned) data[k + 1] << 8 : 0) |
+                                         (k + 2 < n ? data[k + 2] : 0);
+                            base64[b++] = alphabets[url][w >> 18];
+                            base64[b++] = alphabets[url][(w >> 12) & 63];
+                            base64[b++] = k + 1 < n ? alphabets[url][(w >> 6) & 63] : '=';
+                            base64[b++] = k + 2 < n ? alphabets[url][w & 63] : '=';
+                    }
+                    hex[h] = base64[b] = 0;
+                    if (i % 4 >= 2 && n > 0) {
+                            size_t data_chars = (4 * n + 2) / 3, p, r, matched;
+                            seed = seed * 1103515245 + 12345;
+                            p = (seed >> 16) % (2 * n);
+                            hex[p] = 'g';
+                            agree = agree && clam_match_hex(hex, bytes, sizeof(bytes), &size, NULL) == p / 2 * 2 &&
+                                    (p < 2 || (size == p / 2 && !memcmp(bytes, data, size)));
+                            p = (seed >> 8) % data_chars;
+                            r = p % 4;
+                            // Canonical characters of a cut last group
+                            if (r == 3 && (strchr(alphabets[url], base64[p - 1]) - alphabets[url]) & 0x3) {
+                                    r = 2;
+                            }
+                            if (r == 2 && (strchr(alphabets[url], base64[p - p % 4 + 1]) - alphabets[url]) & 0xf) {
+                                    r = 0;
+                            }
+                            base64[p] = '*';
+                            matched = clam_match_base64(base64, url ? CLAM_BASE64_URL : CLAM_BASE64_STANDARD,
+                                                        bytes, sizeof(bytes), &size, NULL);
+                            agree = agree && matched == p - p % 4 + (r > 1 ? r : 0) &&
+                                    (!matched || (size == p / 4 * 3 + (r > 1 ? r - 1 : 0) && !memcmp(bytes, data, size)));
+                    } else if (n > 0) {
+                            agree = agree && clam_match_hex(hex, bytes, n, &size, NULL) == 2 * n &&
+                                    size == n && !memcmp(bytes, data, n);
+                            agree = agree && clam_match_base64(base64, url ? CLAM_BASE64_URL : CLAM_BASE64_STANDARD,
+                                                               bytes, n, &size, NULL) == b &&
+                                    size == n && !memcmp(bytes, data, n);
+                    }
+            }
+            ASSERT(agree,
+                "`clam_match_hex` and `clam_match_base64` should decode what was encoded up to an invalid character");
+        }
+
+        {
+            printf("# Lists\n");
+
+            clam_list_t list;
+            clam_slice_t item;
+            const char *features = "alpha,beta,,gamma\\,delta,";
+            clam_list_init(&list, features, strlen(features), ',', '\\');
+            ASSERT(clam_list_next(&list, &item) && item.ptr == features && item.len == 5,
+                "`clam_list_next` should yield a slice of the value");
+            ASSERT(clam_list_next(&list, &item) && item.len == 4 && !memcmp(item.ptr, "beta", 4),
+                "`clam_list_next` should yield the next element");
+            ASSERT(clam_list_next(&list, &item) && item.len == 0,
+                "`clam_list_next` should yield an empty element between delimiters");
+            ASSERT(clam_list_next(&list, &item) && item.len == 12 && !memcmp(item.ptr, "gamma\\,delta", 12),
+                "`clam_list_next` should not split at an escaped delimiter");
+            char unescaped[16];
+            ASSERT(clam_slice_unescape(item, '\\', unescaped) == 11 && !memcmp(unescaped, "gamma,delta", 11),
+                "`clam_slice_unescape` should remove escape characters");
+            ASSERT(clam_list_next(&list, &item) && item.len == 0 && item.ptr == features + strlen(features),
+                "`clam_list_next` should yield an empty element after a trailing delimiter");
+            ASSERT(!clam_list_next(&list, &item) && !clam_list_next(&list, &item),
+                "`clam_list_next` should stop at the end");
+            ASSERT(clam_list_count(features, strlen(features), ',', '\\') == 5,
+                "`clam_list_count` should count elements");
+            ASSERT(clam_list_count(features, strlen(features), ',', '\0') == 6,
+                "`clam_list_count` should not treat anything as an escape if told so");
+
+            clam_list_init(&list, "", 0, ',', '\0');
+            ASSERT(!clam_list_next(&list, &item) && clam_list_count("", 0, ',', '\0') == 0,
+                "an empty value should have no elements");
+            clam_list_init(&list, "x:y", 3, ':', '\0');
+            ASSERT(clam_list_next(&list, &item) && item.len == 1 && clam_list_next(&list, &item) && item.ptr[0] == 'y',
+                "`clam_list_next` should use the given delimiter");
+
+            // Splitting and counting against a straightforward splitter
+            int agree = 1, i;
+            unsigned seed = 5;
+            for (i = 0; i < 3000; i++) {
+                    char text[200];
+                    size_t n, k, count = 0, start = 0;
+                    int escaped = 0;
+                    char escape = i % 3 ? '\\' : '\0';
+                    seed = seed * 1103515245 + 12345;
+                    n = (seed >> 16) % 200;
+                    for (k = 0; k < n; k++) {
+                            seed = seed * 1103515245 + 12345;
+                            text[k] = "abcdefgh,,\\"[(seed >> 16) % (i % 2 ? 11 : 9)];
+                    }
+                    clam_list_init(&list, text, n, ',', escape);
+                    for (k = 0; k <= n && n > 0; k++) {
+                            if (k == n || (!escaped && text[k] == ',')) {
+                                    agree = agree && clam_list_next(&list, &item) && item.ptr == text + start &&
+                                            item.len == k - start;
+                                    count++;
+                                    start = k + 1;
+                            }
+                            escaped = !escaped && escape && k < n && text[k] == escape;
+                    }
+                    agree = agree && !clam_list_next(&list, &item) && clam_list_count(text, n, ',', escape) == count;
+            }
+            ASSERT(agree,
+                "`clam_list_next` and `clam_list_count` should agree with a straightforward splitter");
+        }
+
+        {
+            printf("# Numeric lists\n");
+
+            uint64_t u64[8];
+            uint32_t u32[8];
+            int64_t i64[8];
+            clam_error_t errors[8];
+            const char *ids = "1,22,333,4444444444,18446744073709551615,18446744073709551616,x1,";
+            ASSERT(clam_list_parse_u64(ids, strlen(ids), ',', u64, errors, 8) == 8 &&
+                   u64[0] == 1 && u64[1] == 22 && u64[2] == 333 && u64[3] == UINT64_C(4444444444) &&
+                   u64[4] == UINT64_MAX && errors[4] == CLAM_ERROR_NONE,
+                "`clam_list_parse_u64` should convert every element");
+            ASSERT(errors[5] == CLAM_ERROR_RANGE && u64[5] == 0,
+                "`clam_list_parse_u64` should report an element that does not fit");
+            ASSERT(errors[6] == CLAM_ERROR_INVALID && errors[7] == CLAM_ERROR_INVALID,
+                "`clam_list_parse_u64` should report elements that are not numbers");
+            ASSERT(clam_list_parse_u64(ids, strlen(ids), ',', u64, NULL, 2) == 8 && u64[1] == 22,
+                "`clam_list_parse_u64` should count elements past its capacity");
+            ASSERT(clam_list_parse_u32(ids, strlen(ids), ',', u32, errors, 8) == 8 &&
+                   u32[2] == 333 && errors[3] == CLAM_ERROR_RANGE,
+                "`clam_list_parse_u32` should report an element that does not fit");
+            ASSERT(clam_list_parse_u32("4294967295:0007", 15, ':', u32, errors, 8) == 2 && u32[0] == UINT32_MAX &&
+                   u32[1] == 7 && errors[1] == CLAM_ERROR_NONE,
+                "`clam_list_parse_u32` should use the given delimiter and accept leading zeros");
+            const char *offsets = "-1,+2,-9223372036854775808,9223372036854775808,-,3";
+            ASSERT(clam_list_parse_i64(offsets, strlen(offsets), ',', i64, errors, 8) == 6 &&
+                   i64[0] == -1 && i64[1] == 2 && i64[2] == INT64_MIN && errors[3] == CLAM_ERROR_RANGE &&
+                   errors[4] == CLAM_ERROR_INVALID && i64[5] == 3,
+                "`clam_list_parse_i64` should convert signed elements");
+            ASSERT(clam_list_parse_u64("", 0, ',', u64, errors, 8) == 0,
+                "an empty numeric list should have no elements");
+
+            // Conversion against strtoull for numbers of every length
+            int agree = 1, i;
+            unsigned seed = 9;
+            for (i = 0; i < 4000; i++) {
+                    char text[64 * 22 + 1];
+                    uint64_t values[64];
+                    clam_error_t status[64];
+                    size_t n = 0, k, count = (size_t) i % 64;
+                    for (k = 0; k < count; k++) {
+                            int digits = 1 + (int) ((seed >> 8) % 21), d;
+                            for (d = 0; d < digits; d++) {
+                                    seed = seed * 1103515245 + 12345;
+                                    text[n++] = (char) ('0' + (seed >> 16) % 10);
+                            }
+                            text[n++] = ',';
+                    }
+                    n = n ? n - 1 : 0;
+                    text[n] = 0;
+                    agree = agree && clam_list_parse_u64(text, n, ',', values, status, 64) == count;
+                    const char *element = text;
+                    for (k = 0; k < count && agree; k++) {
+                            char *end;
+                            errno = 0;
+                            uint64_t expected = strtoull(element, &end, 10);
+                            agree = errno == ERANGE ? status[k] == CLAM_ERROR_RANGE
+                                                    : status[k] == CLAM_ERROR_NONE && values[k] == expected;
+                            element = end + 1;
+                    }
+            }
+            ASSERT(agree,
+                "`clam_list_parse_u64` should agree with `strtoull`");
+        }
+
+        {
+            printf("# CPU lists\n");
+
+            uint64_t cpus[4];
+            clam_error_t error = CLAM_ERROR_NONE;
+            ASSERT(clam_match_cpulist("0-3,8-11,16", cpus, 256, &error) == strlen("0-3,8-11,16") &&
+                   cpus[0] == UINT64_C(0x10f0f) && !cpus[1] && !cpus[2] && !cpus[3],
+                "`clam_match_cpulist` should set numbers and ranges");
+            ASSERT(clam_match_cpulist("0-255:2 ", cpus, 256, &error) == strlen("0-255:2") &&
+                   cpus[0] == UINT64_C(0x5555555555555555) && cpus[3] == UINT64_C(0x5555555555555555),
+                "`clam_match_cpulist` should set a range with a stride");
+            ASSERT(clam_match_cpulist("1-200:3", cpus, 256, &error) &&
+                   cpus[0] == UINT64_C(0x2492492492492492) && cpus[1] == UINT64_C(0x9249249249249249) &&
+                   cpus[2] == UINT64_C(0x4924924924924924) && cpus[3] == UINT64_C(0x92),
+                "`clam_match_cpulist` should carry a stride over words");
+            ASSERT(clam_match_cpulist("5-250:100,63", cpus, 256, &error) &&
+                   cpus[0] == (UINT64_C(1) << 5 | UINT64_C(1) << 63) && cpus[1] == UINT64_C(1) << 41 &&
+                   cpus[3] == UINT64_C(1) << 13,
+                "`clam_match_cpulist` should set a range with a stride wider than a word");
+            ASSERT(!clam_match_cpulist("0-3,256", cpus, 256, &error) && error == CLAM_ERROR_RANGE,
+                "`clam_match_cpulist` should reject a number out of bounds");
+            ASSERT(!clam_match_cpulist("0-7,4", cpus, 256, &error) && error == CLAM_ERROR_DUPLICATE,
+                "`clam_match_cpulist` should reject overlapping ranges");
+            ASSERT(clam_match_cpulist("0-7:2,1-7:2", cpus, 256, &error) && cpus[0] == 0xff,
+                "`clam_match_cpulist` should accept interleaved ranges");
+            error = CLAM_ERROR_NONE;
+            ASSERT(!clam_match_cpulist("3-1", cpus, 256, &error) && error == CLAM_ERROR_INVALID &&
+                   !clam_match_cpulist("0-3:0", cpus, 256, NULL) &&
+                   !clam_match_cpulist("0,", cpus, 256, NULL) &&
+                   !clam_match_cpulist("", cpus, 256, NULL),
+                "`clam_match_cpulist` should reject malformed lists");
+
+            // Word-wide fills against setting one bit at a time
+            int agree = 1, i;
+            unsigned seed = 5;
+            for (i = 0; i < 20000 && agree; i++) {
+                    uint64_t expected[4] = {0}, first, last, stride, k;
+                    char text[32];
+                    seed = seed * 1103515245 + 12345;
+                    first = (seed >> 8) % 256;
+                    seed = seed * 1103515245 + 12345;
+                    last = first + (seed >> 8) % (256 - first);
+                    seed = seed * 1103515245 + 12345;
+                    stride = 1 + (seed >> 8) % 100;
+                    for (k = first; k <= last; k += stride) {
+                            expected[k / 64] |= UINT64_C(1) << (k % 64);
+                    }
+                    snprintf(text, sizeof(text), "%u-%u:%u", (unsigned) first, (unsigned) last, (unsigned) stride);
+                    agree = clam_match_cpulist(text, cpus, 256, NULL) == strlen(text) &&
+                            !memcmp(cpus, expected, sizeof(cpus));
+            }
+            ASSERT(agree,
+                "`clam_match_cpulist` should agree with setting one bit at a time");
+        }
+
+        {
+            printf("# Configuration overrides\n");
+
+            clam_slice_t key, value;
+            ASSERT(clam_match_override("server.pool.size=64", &key, &value) == strlen("server.pool.size=64") &&
+                   key.len == strlen("server.pool.size") && value.ptr[0] == '6' && value.len == 2,
+                "`clam_match_override` should split a key path and its value");
+            ASSERT(clam_match_override("log_level=", &key, &value) == strlen("log_level=") && value.len == 0,
+                "`clam_match_override` should match an empty value");
+            ASSERT(!clam_match_override("server..size=1", &key, &value) &&
+                   !clam_match_override(".size=1", &key, &value) &&
+                   !clam_match_override("size.=1", &key, &value) &&
+                   !clam_match_override("size", &key, &value) &&
+                   !clam_match_override("=1", &key, &value),
+                "`clam_match_override` should not match a malformed key path");
+
+            clam_override_t nodes[8];
+            uint32_t slots[8];
+            char arena[32], path[32];
+            clam_overrides_t overrides;
+            ASSERT(clam_overrides_init(&overrides, nodes, 8, slots, 6, arena, sizeof(arena)) == CLAM_ERROR_INVALID &&
+                   clam_overrides_init(&overrides, nodes, 8, slots, 8, arena, sizeof(arena)) == CLAM_ERROR_NONE,
+                "`clam_overrides_init` should require a power of two slots");
+            ASSERT(clam_overrides_set(&overrides, "server.pool.size", 16, "64", 2) == CLAM_ERROR_NONE &&
+                   clam_overrides_set(&overrides, "server.port", 11, "80", 2) == CLAM_ERROR_NONE &&
+                   clam_overrides_set(&overrides, "server.pool.idle", 16, "5", 1) == CLAM_ERROR_NONE &&
+                   clam_overrides_set(&overrides, "pool", 4, "1", 1) == CLAM_ERROR_NONE &&
+                   clam_overrides_set(&overrides, "server.port", 11, "8080", 4) == CLAM_ERROR_NONE &&
+                   overrides.count == 7 && overrides.arena_size == strlen("serverpoolsizeportidlepool"),
+                "`clam_overrides_set` should share the nodes of common prefixes");
+            int node = clam_overrides_find(&overrides, "server.port", 11);
+            ASSERT(node > 0 && nodes[node].value_length == 4 && !memcmp(nodes[node].value, "8080", 4),
+                "`clam_overrides_find` should find the latest value of a path");
+            ASSERT(clam_overrides_find(&overrides, "server.pool.size", 16) > 0 &&
+                   clam_overrides_find(&overrides, "pool", 4) > 0 &&
+                   clam_overrides_find(&overrides, "server.pool.siz", 15) == -1 &&
+                   clam_overrides_find(&overrides, "server.pool.size.x", 18) == -1 &&
+                   clam_overrides_find(&overrides, "size", 4) == -1 &&
+                   clam_overrides_find(&overrides, "", 0) == 0,
+                "`clam_overrides_find` should only find paths that were added");
+            uint32_t cursor = 0;
+            int n = 0, ordered = 1;
+            const char *expected[] = {"server.pool.size", "server.pool.idle", "server.port"};
+            while (clam_overrides_next(&overrides, (uint32_t) clam_overrides_find(&overrides, "server", 6), &cursor)) {
+                    size_t length = clam_overrides_key(&overrides, cursor, path, sizeof(path));
+                    ordered = ordered && n < 3 && length == strlen(expected[n]) && !memcmp(path, expected[n], length);
+                    n++;
+            }
+            ASSERT(ordered && n == 3,
+                "`clam_overrides_next` should visit a subtree in the order paths were added");
+            cursor = 0;
+            n = 0;
+            while (clam_overrides_next(&overrides, 0, &cursor)) {
+                    n++;
+            }
+            ASSERT(n == 4,
+                "`clam_overrides_next` should visit every value from the root");
+            cursor = 0;
+            node = clam_overrides_find(&overrides, "pool", 4);
+            ASSERT(clam_overrides_next(&overrides, (uint32_t) node, &cursor) && cursor == (uint32_t) node &&
+                   !clam_overrides_next(&overrides, (uint32_t) node, &cursor),
+                "`clam_overrides_next` should visit a leaf itself");
+            ASSERT(clam_overrides_key(&overrides, (uint32_t) node, path, 2) == 4,
+                "`clam_overrides_key` should return the length of a key that does not fit");
+            ASSERT(clam_overrides_set(&overrides, "a.b", 3, "", 0) == CLAM_ERROR_CAPACITY &&
+                   clam_overrides_set(&overrides, "a..b", 4, "", 0) == CLAM_ERROR_INVALID &&
+                   clam_overrides_set(&overrides, "", 0, "", 0) == CLAM_ERROR_INVALID,
+                "`clam_overrides_set` should report exhausted storage and malformed paths");
+        }
+
+        {
+            printf("# Multi-call dispatch\n");
+
+            const char *path = "/usr/local/lib/very/long/directory/name/bin/ls";
+            ASSERT(clam_match_dirname(path) == strlen(path) - 2,
+                "`clam_match_dirname` should match up to the last slash");
+            ASSERT(clam_match_dirname("ls") == 0 && clam_match_dirname("") == 0,
+                "`clam_match_dirname` should not match a name without slashes");
+            ASSERT(clam_match_dirname("/") == 1 && clam_match_dirname("./ls") == 2,
+                "`clam_match_dirname` should match a short directory");
+            ASSERT(clam_match_dirname("/a/b/cccccccccccccccccccccccccccccccccccc") == 5,
+                "`clam_match_dirname` should find a slash more than 16 bytes from the end");
+            ASSERT(clam_match_dirname_n(path, 5) == 5 && clam_match_dirname_n(path, 4) == 1,
+                "`clam_match_dirname_n` should only look at the first `length` characters");
+
+            int agree = 1, i;
+            for (i = 0; i < 64 && agree; i++) {
+                    char text[64];
+                    int k;
+                    for (k = 0; k < i; k++) {
+                            text[k] = "ab/"[(k * 7 + i) % 5 % 3];
+                    }
+                    const char *slash = NULL;
+                    for (k = 0; k < i; k++) {
+                            slash = text[k] == '/' ? text + k : slash;
+                    }
+                    agree = clam_match_dirname_n(text, (size_t) i) == (slash ? (size_t) (slash - text) + 1 : 0);
+            }
+            ASSERT(agree,
+                "`clam_match_dirname_n` should agree with a forward search for every length");
+        }
+
+        {
+            printf("# Option constraints\n");
+
+            enum { OPT_OUTPUT, OPT_FORMAT, OPT_QUIET, OPT_VERBOSE, OPT_CREATE, OPT_EXTRACT, OPT_LIST, OPT_ALL,
+                   OPT_HIGH = 200 };
+            clam_option_set_t seen;
+            clam_option_set_clear(&seen);
+            clam_option_set_add(&seen, OPT_FORMAT);
+            clam_option_set_add(&seen, 70);
+            clam_option_set_add(&seen, OPT_HIGH);
+            int option = -1, ids[4], n = 0;
+            while (clam_option_set_next(&seen, &option) && n < 4) {
+                    ids[n++] = option;
+            }
+            ASSERT(n == 3 && ids[0] == OPT_FORMAT && ids[1] == 70 && ids[2] == OPT_HIGH &&
+                   clam_option_set_has(&seen, 70) && !clam_option_set_has(&seen, 71),
+                "`clam_option_set_next` should visit options in order");
+
+            clam_constraint_t storage[8];
+            clam_constraints_t constraints;
+            clam_violation_t violation;
+            clam_constraints_init(&constraints, storage, 8);
+            ASSERT(clam_constraints_requires(&constraints, OPT_OUTPUT, (const int[]){OPT_FORMAT, OPT_HIGH}, 2) == 0 &&
+                   clam_constraints_conflicts(&constraints, OPT_QUIET, (const int[]){OPT_VERBOSE}, 1) == 1 &&
+                   clam_constraints_exactly_one(&constraints, (const int[]){OPT_CREATE, OPT_EXTRACT, OPT_LIST}, 3) == 2 &&
+                   clam_constraints_implies(&constraints, OPT_ALL, (const int[]){OPT_VERBOSE}, 1) == 3 &&
+                   clam_constraints_implies(&constraints, OPT_VERBOSE, (const int[]){OPT_LIST}, 1) == 4,
+                "`clam_constraints_XXX` should add constraints in order");
+            ASSERT(clam_constraints_requires(&constraints, OPT_OUTPUT, (const int[]){CLAM_MAX_OPTIONS}, 1) == -1 &&
+                   clam_constraints_at_most_one(&constraints, (const int[]){-1}, 1) == -1,
+                "`clam_constraints_XXX` should reject option ids out of range");
+
+            clam_option_set_clear(&seen);
+            clam_option_set_add(&seen, OPT_CREATE);
+            ASSERT(clam_constraints_check(&constraints, &seen, &violation) == -1,
+                "`clam_constraints_check` should accept options that satisfy all constraints");
+            clam_option_set_add(&seen, OPT_OUTPUT);
+            clam_option_set_add(&seen, OPT_FORMAT);
+            option = -1;
+            ASSERT(clam_constraints_check(&constraints, &seen, &violation) == 0 &&
+                   violation.kind == CLAM_CONSTRAINT_REQUIRES && violation.option == OPT_OUTPUT &&
+                   clam_option_set_next(&violation.options, &option) && option == OPT_HIGH &&
+                   !clam_option_set_next(&violation.options, &option),
+                "`clam_constraints_check` should report the options that are missing");
+            clam_option_set_add(&seen, OPT_HIGH);
+            clam_option_set_add(&seen, OPT_QUIET);
+            clam_option_set_add(&seen, OPT_ALL);
+            ASSERT(clam_constraints_check(&constraints, &seen, &violation) == 1 &&
+                   violation.kind == CLAM_CONSTRAINT_CONFLICTS && violation.option == OPT_QUIET &&
+                   clam_option_set_has(&violation.options, OPT_VERBOSE),
+                "`clam_constraints_check` should report a conflict with an implied option");
+            clam_option_set_clear(&seen);
+            clam_option_set_add(&seen, OPT_CREATE);
+            clam_option_set_add(&seen, OPT_ALL);
+            ASSERT(clam_constraints_check(&constraints, &seen, &violation) == 2 && violation.option == -1 &&
+                   clam_option_set_has(&violation.options, OPT_CREATE) &&
+                   clam_option_set_has(&violation.options, OPT_LIST) &&
+                   clam_option_set_has(&seen, OPT_LIST),
+                "`clam_constraints_check` should chain implications");
+            clam_option_set_clear(&seen);
+            ASSERT(clam_constraints_check(&constraints, &seen, NULL) == 2,
+                "`clam_constraints_check` should report a group of which no option is seen");
+
+            clam_constraints_init(&constraints, storage, 1);
+            ASSERT(clam_constraints_at_most_one(&constraints, (const int[]){3, 64 + 3}, 2) == 0 &&
+                   clam_constraints_at_least_one(&constraints, (const int[]){3}, 1) == -1,
+                "`clam_constraints_XXX` should stop at the capacity");
+            clam_option_set_add(&seen, 64 + 3);
+            ASSERT(clam_constraints_check(&constraints, &seen, NULL) == -1,
+                "`clam_constraints_check` should accept one option of a group");
+            clam_option_set_add(&seen, 3);
+            ASSERT(clam_constraints_check(&constraints, &seen, NULL) == 0,
+                "`clam_constraints_check` should count options of a group across words");
+        }
+
+        {
+            printf("# Parse records\n");
+
+            uint32_t arena[40];
+            clam_record_t record;
+            ASSERT(clam_record_init(&record, arena, sizeof(arena)) == sizeof(arena) / 15 && record.count == 0,
+                "`clam_record_init` should fit parallel arrays into the arena");
+            ASSERT(clam_record_add(&record, 3, 1, 9, 5, 1) == CLAM_ERROR_NONE &&
+                   clam_record_add(&record, 7, 2, 0, 0, 0) == CLAM_ERROR_NONE &&
+                   clam_record_add(&record, 3, 4, 2, 1, 1) == CLAM_ERROR_NONE &&
+                   record.count == 3 && record.args[2] == 4 && record.offsets[0] == 9 &&
+                   record.lengths[0] == 5 && record.ids[1] == 7 && !record.polarities[1],
+                "`clam_record_add` should append an event to every array");
+            ASSERT(clam_record_find(&record, 3, 0) == 0 && clam_record_find(&record, 3, 1) == 2 &&
+                   clam_record_find(&record, 9, 0) == 3 && clam_record_last(&record, 3) == 2 &&
+                   clam_record_last(&record, 9) == 3,
+                "`clam_record_find` and `clam_record_last` should find events by option id");
+            size_t i;
+            for (i = 3; i < record.capacity; i++) {
+                    clam_record_add(&record, (uint16_t) (i % 5), (uint32_t) i, 0, 0, 1);
+            }
+            ASSERT(clam_record_add(&record, 0, 0, 0, 0, 1) == CLAM_ERROR_CAPACITY,
+                "`clam_record_add` should report a full arena");
+
+            uint32_t indices[16];
+            int agree = 1;
+            uint16_t id;
+            for (id = 0; id < 8; id++) {
+                    size_t n = 0, k;
+                    for (k = 0; k < record.count; k++) {
+                            if (record.ids[k] == id) {
+                                    agree = agree && clam_record_find(&record, id, n ? indices[n - 1] + 1 : 0) == k;
+                                    indices[n++] = (uint32_t) k;
+                            }
+                    }
+                    uint32_t found[16];
+                    agree = agree && clam_record_filter(&record, id, found, 16) == n &&
+                            !memcmp(found, indices, n * sizeof(*found)) &&
+                            clam_record_last(&record, id) == (n ? indices[n - 1] : record.count) &&
+                            clam_record_filter(&record, id, found, 1) == n;
+            }
+            ASSERT(agree,
+                "`clam_record_filter` should agree with a scalar scan");
+        }
+
+        {
+            printf("# Snapshots\n");
+
+            const char *names[] = {"-define", "-verbose", "o"};
+            const char *argv[] = {"cc", "--define=NAME=1", "-o", "out.o", "input.c", "--no-verbose", "lib.c"};
+            uint64_t schema = clam_schema_hash(names, 3);
+            const char *other[] = {"-define", "-verbose", "O"};
+            ASSERT(schema != clam_schema_hash(other, 3) && schema != clam_schema_hash(names, 2),
+                "`clam_schema_hash` should depend on every name");
+
+            uint32_t arena[32], positionals[] = {4, 6};
+            clam_record_t record;
+            clam_record_init(&record, arena, sizeof(arena));
+            clam_record_add(&record, 0, 1, strlen("--define="), strlen("NAME=1"), 1);
+            clam_record_add(&record, 2, 3, 0, strlen("out.o"), 1);
+            clam_record_add(&record, 1, 5, 0, 0, 0);
+
+            uint64_t buffer[32];
+            size_t size = clam_snapshot_write(&record, argv, positionals, 2, schema, NULL, 0);
+            ASSERT(size > sizeof(clam_snapshot_header_t) && size <= sizeof(buffer) &&
+                   clam_snapshot_write(&record, argv, positionals, 2, schema, buffer, sizeof(buffer)) == size,
+                "`clam_snapshot_write` should return the size of the snapshot");
+
+            clam_snapshot_t snapshot;
+            ASSERT(clam_snapshot_open(&snapshot, buffer, size, schema, 3) == CLAM_ERROR_NONE &&
+                   snapshot.record.count == 3 && snapshot.positionals == 2,
+                "`clam_snapshot_open` should open a snapshot");
+            size_t define = clam_record_find(&snapshot.record, 0, 0);
+            ASSERT(define == 0 && !strcmp(snapshot.strings + snapshot.record.offsets[define], "NAME=1") &&
+                   snapshot.record.args[define] == 1 && snapshot.record.polarities[define],
+                "a snapshot should hold the values of options");
+            ASSERT(clam_record_last(&snapshot.record, 1) == 2 && !snapshot.record.polarities[2] &&
+                   snapshot.record.lengths[2] == 0 && snapshot.strings[snapshot.record.offsets[2]] == 0,
+                "a snapshot should hold options without values");
+            ASSERT(!strcmp(snapshot.strings + snapshot.positional_offsets[0], "input.c") &&
+                   !strcmp(snapshot.strings + snapshot.positional_offsets[1], "lib.c") &&
+                   snapshot.positional_lengths[1] == 5,
+                "a snapshot should hold positional arguments");
+
+            ASSERT(clam_snapshot_open(&snapshot, buffer, size, clam_schema_hash(other, 3), 3) == CLAM_ERROR_INVALID &&
+                   clam_snapshot_open(&snapshot, buffer, size - 1, schema, 3) == CLAM_ERROR_INVALID &&
+                   clam_snapshot_open(&snapshot, buffer, 8, schema, 3) == CLAM_ERROR_INVALID,
+                "`clam_snapshot_open` should reject another schema or a truncated snapshot");
+            ((clam_snapshot_header_t *) buffer)->version++;
+            ASSERT(clam_snapshot_open(&snapshot, buffer, size, schema, 3) == CLAM_ERROR_INVALID,
+                "`clam_snapshot_open` should reject another layout version");
+            ((clam_snapshot_header_t *) buffer)->version--;
+            ((char *) buffer)[size - 1] = 'x';
+            ASSERT(clam_snapshot_open(&snapshot, buffer, size, schema, 3) == CLAM_ERROR_INVALID,
+                "`clam_snapshot_open` should reject an unterminated string");
+            ((char *) buffer)[size - 1] = 0;
+            ((uint32_t *) ((clam_snapshot_header_t *) buffer + 1))[3] = 1000;
+            ASSERT(clam_snapshot_open(&snapshot, buffer, size, schema, 3) == CLAM_ERROR_INVALID,
+                "`clam_snapshot_open` should reject a string out of bounds");
+            clam_snapshot_write(&record, argv, positionals, 2, schema, buffer, sizeof(buffer));
+            ASSERT(clam_snapshot_open(&snapshot, buffer, size, schema, 2) == CLAM_ERROR_INVALID,
+                "`clam_snapshot_open` should reject an id out of range");
+        }
+
+        {
+            printf("# Command line hashing\n");
+
+            enum { OPT_LINK, OPT_VERBOSE, OPT_DEFINE };
+            clam_hash_t a, b;
+            uint64_t x[2], y[2];
+            // `-v -lfoo --link=bar -DX` against `--link foo -DX -l bar --verbose`
+            clam_hash_init(&a, 0);
+            clam_hash_option(&a, OPT_VERBOSE, 1, NULL, 0);
+            clam_hash_option_ordered(&a, OPT_LINK, 1, "foo", 3);
+            clam_hash_option_ordered(&a, OPT_LINK, 1, "bar", 3);
+            clam_hash_option(&a, OPT_DEFINE, 1, "X", 1);
+            clam_hash_final(&a, x);
+            clam_hash_init(&b, 0);
+            clam_hash_option_ordered(&b, OPT_LINK, 1, "foo", 3);
+            clam_hash_option(&b, OPT_DEFINE, 1, "X", 1);
+            clam_hash_option_ordered(&b, OPT_LINK, 1, "bar", 3);
+            clam_hash_option(&b, OPT_VERBOSE, 1, NULL, 0);
+            clam_hash_final(&b, y);
+            ASSERT(x[0] == y[0] && x[1] == y[1],
+                "`clam_hash_final` should not depend on the order of unordered options");
+
+            clam_hash_init(&b, 0);
+            clam_hash_option(&b, OPT_VERBOSE, 1, NULL, 0);
+            clam_hash_option_ordered(&b, OPT_LINK, 1, "bar", 3);
+            clam_hash_option_ordered(&b, OPT_LINK, 1, "foo", 3);
+            clam_hash_option(&b, OPT_DEFINE, 1, "X", 1);
+            clam_hash_final(&b, y);
+            ASSERT(x[0] != y[0] && x[1] != y[1],
+                "`clam_hash_final` should depend on the order of ordered options");
+
+            clam_hash_init(&b, 1);
+            clam_hash_final(&b, y);
+            clam_hash_init(&a, 0);
+            clam_hash_final(&a, x);
+            ASSERT(x[0] != y[0] && x[1] != y[1],
+                "`clam_hash_init` should depend on the seed");
+
+            // Events differing in a single attribute
+            static const char *const values[] = {"", "a", "b", "ab", "ba", "0123456789abcdef", "0123456789abcdeg",
+                                                 "0123456789abcdef0", "0123456789abcdef\0"};
+            uint64_t digests[4 * 2 * 9 * 2][2];
+            int n = 0, distinct = 1, id, polarity, v, ordered, k;
+            for (id = 0; id < 4; id++) {
+                    for (polarity = 0; polarity < 2; polarity++) {
+                            for (v = 0; v < 9; v++) {
+                                    for (ordered = 0; ordered < 2; ordered++) {
+                                            size_t length = v == 8 ? 17 : strlen(values[v]);
+                                            clam_hash_init(&a, 0);
+                                            (ordered ? clam_hash_option_ordered : clam_hash_option)(&a, id, polarity,
+                                                                                                   values[v], length);
+                                            clam_hash_final(&a, digests[n]);
+                                            for (k = 0; k < n; k++) {
+                                                    distinct = distinct && (digests[k][0] != digests[n][0] ||
+                                                                            digests[k][1] != digests[n][1]);
+                                            }
+                                            n++;
+                                    }
+                            }
+                    }
+            }
+            ASSERT(distinct,
+                "`clam_hash_final` should distinguish ids, polarities, values and ordering");
+
+            // Blocks that zero one or both lanes of the value mixing
+            static const unsigned char zeroing[][16] = {
+                {'v', 'a', 'l', 'u', 'e', 0, 0, 0, 0xc3, 0x4c, 0x37, 0x75, 0xcc, 0x65, 0x99, 0x58},
+                {0x2f, 0x64, 0xbd, 0x78, 0x64, 0x1d, 0x76, 0xa0, 0xc3, 0x4c, 0x37, 0x75, 0xcc, 0x65, 0x99, 0x58},
+            };
+            distinct = 1;
+            for (v = 0; v < 2; v++) {
+                    for (ordered = 0; ordered < 2; ordered++) {
+                            void (*add)(clam_hash_t *, int, int, const char *, size_t) =
+                              ordered ? clam_hash_option_ordered : clam_hash_option;
+                            clam_hash_init(&a, 0);
+                            add(&a, 1, 1, (const char *) zeroing[v], 16);
+                            clam_hash_final(&a, x);
+                            clam_hash_init(&b, 0);
+                            add(&b, 2, 0, (const char *) zeroing[v], 16);
+                            clam_hash_final(&b, y);
+                            distinct = distinct && x[0] != y[0] && x[1] != y[1];
+                    }
+            }
+            ASSERT(distinct,
+                "`clam_hash_final` should distinguish ids and polarities of any value");
+
+            const char *argv[] = {"cc", "-lfoo", "--define=X", "--link", "bar"};
+            uint32_t arena[16];
+            clam_record_t record;
+            clam_option_set_t order;
+            clam_record_init(&record, arena, sizeof(arena));
+            clam_record_add(&record, OPT_LINK, 1, 2, 3, 1);
+            clam_record_add(&record, OPT_DEFINE, 2, strlen("--define="), 1, 1);
+            clam_record_add(&record, OPT_LINK, 4, 0, 3, 1);
+            clam_option_set_clear(&order);
+            clam_option_set_add(&order, OPT_LINK);
+            clam_hash_init(&a, 0);
+            clam_hash_record(&a, &record, argv, &order);
+            clam_hash_final(&a, x);
+            clam_hash_init(&b, 0);
+            clam_hash_option(&b, OPT_DEFINE, 1, "X", 1);
+            clam_hash_option_ordered(&b, OPT_LINK, 1, "foo", 3);
+            clam_hash_option_ordered(&b, OPT_LINK, 1, "bar", 3);
+            clam_hash_final(&b, y);
+            ASSERT(x[0] == y[0] && x[1] == y[1],
+                "`clam_hash_record` should hash the values of recorded options");
+
+            clam_record_add(&record, CLAM_MAX_OPTIONS + 1, 1, 2, 3, 1);
+            clam_hash_init(&a, 0);
+            clam_hash_record(&a, &record, argv, &order);
+            clam_hash_final(&a, x);
+            clam_hash_option(&b, CLAM_MAX_OPTIONS + 1, 1, "foo", 3);
+            clam_hash_final(&b, y);
+            ASSERT(x[0] == y[0] && x[1] == y[1],
+                "`clam_hash_record` should combine ids past `CLAM_MAX_OPTIONS` commutatively");
+        }
+
+#ifdef CLAM_CACHE
+        {
+            printf("# Parse cache\n");
+
+            const char *argv[] = {"cc", "--define=X", "input.c"}, *names[] = {"-define"};
+            uint64_t key[2], other[2];
+            clam_hash_argv(3, argv, key);
+            argv[2] = "input.h";
+            clam_hash_argv(3, argv, other);
+            ASSERT(key[0] != other[0] && key[1] != other[1],
+                "`clam_hash_argv` should depend on every argument");
+            argv[2] = "input.c";
+
+            char directory[] = "/tmp/clam-cache-XXXXXX";
+            ASSERT(mkdtemp(directory) != NULL,
+                "a cache directory should be created");
+            clam_cache_t cache = {directory, 4, 256, clam_schema_hash(names, 1), 1};
+            uint32_t arena[16], positionals[] = {2};
+            clam_record_t record;
+            clam_record_init(&record, arena, sizeof(arena));
+            clam_record_add(&record, 0, 1, strlen("--define="), 1, 1);
+
+            clam_snapshot_t snapshot;
+            clam_cache_entry_t entry;
+            ASSERT(clam_cache_lookup(&cache, key, &snapshot, &entry) == CLAM_ERROR_INVALID && !entry.mapping,
+                "`clam_cache_lookup` should miss in an empty cache");
+            ASSERT(clam_cache_store(&cache, key, &record, argv, positionals, 1) == CLAM_ERROR_NONE,
+                "`clam_cache_store` should store a snapshot");
+            ASSERT(clam_cache_lookup(&cache, key, &snapshot, &entry) == CLAM_ERROR_NONE &&
+                   snapshot.record.count == 1 && !strcmp(snapshot.strings + snapshot.record.offsets[0], "X") &&
+                   !strcmp(snapshot.strings + snapshot.positional_offsets[0], "input.c"),
+                "`clam_cache_lookup` should find a stored snapshot");
+            clam_cache_release(&entry);
+            ASSERT(!entry.mapping,
+                "`clam_cache_release` should unmap an entry");
+            other[0] = key[0] + 4;
+            ASSERT(clam_cache_lookup(&cache, other, &snapshot, &entry) == CLAM_ERROR_INVALID,
+                "`clam_cache_lookup` should miss another key in the same slot");
+            cache.schema++;
+            ASSERT(clam_cache_lookup(&cache, key, &snapshot, &entry) == CLAM_ERROR_INVALID,
+                "`clam_cache_lookup` should miss a snapshot of another schema");
+            cache.schema--;
+            ASSERT(clam_cache_store(&cache, other, &record, argv, positionals, 1) == CLAM_ERROR_NONE &&
+                   clam_cache_lookup(&cache, key, &snapshot, &entry) == CLAM_ERROR_INVALID &&
+                   clam_cache_lookup(&cache, other, &snapshot, &entry) == CLAM_ERROR_NONE,
+                "`clam_cache_store` should replace the entry in a slot");
+            clam_cache_release(&entry);
+
+            // Temporary files of a writer that died before renaming them
+            char stale[64], fresh[64];
+            struct timespec times[2] = {{0, 0}, {0, 0}};
+            snprintf(stale, sizeof(stale), "%s/.00000000.0123456789abcdef", directory);
+            snprintf(fresh, sizeof(fresh), "%s/.00000001.0123456789abcdef", directory);
+            close(open(stale, O_WRONLY | O_CREAT, 0644));
+            close(open(fresh, O_WRONLY | O_CREAT, 0644));
+            utimensat(AT_FDCWD, stale, times, 0);
+            ASSERT(clam_cache_store(&cache, other, &record, argv, positionals, 1) == CLAM_ERROR_NONE &&
+                   access(stale, F_OK) != 0 && access(fresh, F_OK) == 0,
+                "`clam_cache_store` should remove stale temporary files only");
+            unlink(fresh);
+
+            cache.max_entry = 16;
+            ASSERT(clam_cache_store(&cache, key, &record, argv, positionals, 1) == CLAM_ERROR_CAPACITY,
+                "`clam_cache_store` should not store a snapshot larger than `max_entry`");
+
+            char path[64];
+            unsigned slot;
+            for (slot = 0; slot < 4; slot++) {
+                    snprintf(path, sizeof(path), "%s/%08x", directory, slot);
+                    unlink(path);
+            }
+            ASSERT(rmdir(directory) == 0,
+                "the cache should leave no temporary files behind");
+        }
+#endif
+
+        {
+            printf("# Incremental parsing\n");
+
+            static uint32_t arena[15 * 16], full_arena[15 * 16];
+            uint32_t spans[16], full_spans[16];
+            clam_record_t record, full;
+            clam_incremental_t parser, reference;
+            clam_record_init(&record, arena, sizeof(arena));
+            clam_record_init(&full, full_arena, sizeof(full_arena));
+            clam_incremental_init(&parser, link_step, NULL, &record, spans, 16);
+            clam_incremental_init(&reference, link_step, NULL, &full, full_spans, 16);
+
+            const char *args[16] = {"a", "--link", "x", "-v", "b", "--link", "y", "c", "d", "e"};
+            size_t n = 10;
+#define SAME_AS_FULL_PARSE() (clam_incremental_parse(&reference, args, n) == CLAM_ERROR_NONE && \
+                              record.count == full.count && \
+                              memcmp(record.args, full.args, full.count * sizeof(uint32_t)) == 0 && \
+                              memcmp(record.ids, full.ids, full.count * sizeof(uint16_t)) == 0 && \
+                              memcmp(record.lengths, full.lengths, full.count * sizeof(uint32_t)) == 0)
+            ASSERT(clam_incremental_parse(&parser, args, n) == CLAM_ERROR_NONE && record.count == 8 &&
+                   parser.reparsed == n,
+                "`clam_incremental_parse` should run a step for every argument");
+
+            args[8] = "dd";
+            ASSERT(clam_incremental_update(&parser, args, n, 8, 1, 1) == CLAM_ERROR_NONE &&
+                   SAME_AS_FULL_PARSE() && parser.reparsed == 2,
+                "`clam_incremental_update` should only re-run the steps next to a replaced argument");
+
+            args[4] = "--link";
+            ASSERT(clam_incremental_update(&parser, args, n, 4, 1, 1) == CLAM_ERROR_NONE &&
+                   SAME_AS_FULL_PARSE() && record.count == 8 && record.args[3] == 5,
+                "`clam_incremental_update` should re-run steps until they line up again");
+
+            memmove(args + 2, args + 1, (n - 1) * sizeof(args[0]));
+            args[1] = "-q";
+            n++;
+            ASSERT(clam_incremental_update(&parser, args, n, 1, 0, 1) == CLAM_ERROR_NONE &&
+                   SAME_AS_FULL_PARSE() && parser.reparsed <= 3,
+                "`clam_incremental_update` should shift the events after an insertion");
+
+            memmove(args + 1, args + 3, (n - 3) * sizeof(args[0]));
+            n -= 2;
+            ASSERT(clam_incremental_update(&parser, args, n, 1, 2, 0) == CLAM_ERROR_NONE &&
+                   SAME_AS_FULL_PARSE(),
+                "`clam_incremental_update` should shift the events after a removal");
+
+            args[n] = "--link";
+            n++;
+            ASSERT(clam_incremental_update(&parser, args, n, n - 1, 0, 1) == CLAM_ERROR_NONE &&
+                   SAME_AS_FULL_PARSE(),
+                "`clam_incremental_update` should parse appended arguments");
+            args[n] = "z";
+            n++;
+            ASSERT(clam_incremental_update(&parser, args, n, n - 1, 0, 1) == CLAM_ERROR_NONE &&
+                   SAME_AS_FULL_PARSE() && parser.reparsed == 2,
+                "`clam_incremental_update` should re-run the step that looks at an appended argument");
+#undef SAME_AS_FULL_PARSE
+
+            ASSERT(clam_incremental_update(&parser, args, n, 0, 1, 0) == CLAM_ERROR_INVALID && record.count == 0,
+                "`clam_incremental_update` should reject an edit that does not match the arguments");
+            record.capacity = 4;
+            ASSERT(clam_incremental_parse(&parser, args, n) == CLAM_ERROR_CAPACITY && record.count == 0,
+                "`clam_incremental_parse` should report a full record");
+        }
+
+        {
+            printf("# Push parsing\n");
+
+            static const char command[] = "a\0--link\0x\0--link\0--\0-v\0--\0b\0--link\0c";
+            const char *expected = "0Aa 1A--link 2Vx 3A--link 4V-- 5A-v 7Ob 8O--link 9Oc ";
+            char buffer[16], log[256] = "";
+            clam_push_t parser;
+            clam_push_init(&parser, push_argument, log, buffer, sizeof(buffer));
+            ASSERT(clam_push_feed(&parser, command, sizeof(command) - 1) == CLAM_ERROR_NONE &&
+                   strcmp(log, "0Aa 1A--link 2Vx 3A--link 4V-- 5A-v 7Ob 8O--link ") == 0 &&
+                   clam_push_finish(&parser) == CLAM_ERROR_NONE && strcmp(log, expected) == 0,
+                "`clam_push_feed` should pass on arguments, values and operands after `--`");
+
+            size_t split, i;
+            int same = 1;
+            for (split = 1; split < sizeof(command); split++) {
+                    log[0] = '\0';
+                    clam_push_init(&parser, push_argument, log, buffer, sizeof(buffer));
+                    for (i = 0; i < sizeof(command) - 1; i += split) {
+                            size_t n = sizeof(command) - 1 - i < split ? sizeof(command) - 1 - i : split;
+                            same = same && clam_push_feed(&parser, command + i, n) == CLAM_ERROR_NONE;
+                    }
+                    same = same && clam_push_finish(&parser) == CLAM_ERROR_NONE && strcmp(log, expected) == 0;
+            }
+            ASSERT(same, "`clam_push_feed` should give the same results for any fragmentation");
+
+            log[0] = '\0';
+            clam_push_init(&parser, push_argument, log, buffer, sizeof(buffer));
+            ASSERT(clam_push_feed(&parser, "-v\0--li", 7) == CLAM_ERROR_NONE && strcmp(log, "0A-v ") == 0 &&
+                   clam_push_feed(&parser, "nk", 2) == CLAM_ERROR_NONE && strcmp(log, "0A-v ") == 0 &&
+                   clam_push_feed(&parser, "\0", 1) == CLAM_ERROR_NONE && strcmp(log, "0A-v 1A--link ") == 0,
+                "`clam_push_feed` should pass on an argument as soon as it is complete");
+            ASSERT(clam_push_finish(&parser) == CLAM_ERROR_INVALID,
+                "`clam_push_finish` should report a value still to be bound");
+            ASSERT(clam_push_feed(&parser, "0123456789abcdef", 16) == CLAM_ERROR_CAPACITY,
+                "`clam_push_feed` should report a split argument longer than the buffer");
+        }
+
         return error_code;
 }
@@ -0,0 +1,199 @@
+#include <cstdio>
+
+#include "clam.hpp"
+
+#ifdef QUIET
+#define printf(...)
+#endif
+
+static int error_code = 0;
+static int print_positive_assert = true;
+
+void disable_positive_asserts() {
+        print_positive_assert = false;
+}
+void enable_positive_asserts() {
+        print_positive_assert = true;
+}
+
+#define ASSERT(x, description) { int x_; \
+        if (!(x_ = x)) { \
+                printf("* [ ] **Failure:** %s does not hold, got %d (%s:%d)\n          %s\n", description, x_, __FILE__, __LINE__, #x); \
+                error_code = 1; \
+        } else { \
+                if (print_positive_assert) { \
+                  printf("* [X] Success: %s\n", description); \
+                } \
+        } \
+}
+
+#define OPTIONS(X) \
+        X(help, "-help") \
+        X(help_short, "h") \
+        X(link, "-link") \
+        X(link_legacy, "link") \
+        X(link_short, "l") \
+        X(verbose, "-verbose") \
+        X(version, "-version") \
+        X(output, "o")
+
+CLAM_SCHEMA(option, options, OPTIONS);
+
+enum windows_switch { sw_help, sw_quiet, sw_file };
+static constexpr auto switches = clam::make_schema<windows_switch>({
+        {sw_file, "file"},
+        {sw_help, "?"},
+        {sw_quiet, "quiet"},
+});
+
+#define MANY(X) \
+        X(a0, "-abort") X(a1, "-all") X(a2, "-append") X(a3, "-archive") \
+        X(a4, "-backup") X(a5, "-batch") X(a6, "-binary") X(a7, "-block-size") \
+        X(a8, "-bytes") X(a9, "-cache") X(a10, "-check") X(a11, "-chmod") \
+        X(a12, "-chown") X(a13, "-color") X(a14, "-compress") X(a15, "-config") \
+        X(a16, "-context") X(a17, "-copy") X(a18, "-count") X(a19, "-debug") \
+        X(a20, "-define") X(a21, "-delete") X(a22, "-depth") X(a23, "-dereference") \
+        X(a24, "-dry-run") X(a25, "-exclude") X(a26, "-exec") X(a27, "-force") \
+        X(a28, "-format") X(a29, "-group") X(a30, "-help") X(a31, "-include") \
+        X(a32, "-interactive") X(a33, "-jobs") X(a34, "-keep") X(a35, "-level") \
+        X(a36, "-link") X(a37, "-list") X(a38, "-log") X(a39, "-mode") \
+        X(a40, "a") X(a41, "b") X(a42, "c") X(a43, "d") X(a44, "e") \
+        X(a45, "f") X(a46, "g") X(a47, "h")
+
+CLAM_SCHEMA(many_option, many_options, MANY);
+
+#define APPLETS(X) \
+        X(ls, "ls") X(cat, "cat") X(cp, "cp") X(mv, "mv") X(rm, "rm") X(sh, "sh") \
+        X(true_, "true") X(false_, "false") X(grep, "grep") X(sed, "sed")
+
+CLAM_SCHEMA(applet, applets, APPLETS);
+
+int main()
+{
+        {
+            printf("# Option schemas\n");
+
+            static_assert(options.size == 8);
+            static_assert(options.find("-help") == option::help);
+            static_assert(options.find("l") == option::link_short);
+            static_assert(!options.find("-hel"));
+            static_assert(!options.find("-helpp"));
+            static_assert(options.name(option::version) == "-version");
+            static_assert(options.match_posix_long_option(std::string_view("--link=x")).length == 6);
+
+            auto m = options.match_posix_long_option("--link");
+            ASSERT(m && m.id == option::link && m.length == strlen("--link"),
+                "`schema::match_posix_long_option` should match an exact name");
+            m = options.match_posix_long_option("--link=foo");
+            ASSERT(m && m.id == option::link && m.length == strlen("--link"),
+                "`schema::match_posix_long_option` should match a name followed by `=`");
+            m = options.match_posix_long_option("-link");
+            ASSERT(m && m.id == option::link_legacy,
+                "`schema::match_posix_long_option` should match a single-dash name");
+            m = options.match_posix_long_option("-o");
+            ASSERT(m && m.id == option::output && m.length == 2,
+                "`schema::match_posix_long_option` should match a single-character name");
+            ASSERT(!options.match_posix_long_option("--linker"),
+                "`schema::match_posix_long_option` should not match a longer name");
+            ASSERT(!options.match_posix_long_option("--lin"),
+                "`schema::match_posix_long_option` should not match a shorter name");
+            ASSERT(!options.match_posix_long_option("link"),
+                "`schema::match_posix_long_option` should not match a name without a dash");
+            ASSERT(!options.match_posix_long_option("-"),
+                "`schema::match_posix_long_option` should not match a dash alone");
+            ASSERT(!options.match_posix_long_option(""),
+                "`schema::match_posix_long_option` should not match an empty string");
+
+            auto s = switches.match_windows_long_switch("/quiet");
+            ASSERT(s && s.id == sw_quiet && s.length == strlen("/quiet"),
+                "`schema::match_windows_long_switch` should match an exact name");
+            s = switches.match_windows_long_switch(std::string_view("/?"));
+            ASSERT(s && s.id == sw_help,
+                "`schema::match_windows_long_switch` should match a string view");
+            ASSERT(!switches.match_windows_long_switch("-quiet"),
+                "`schema::match_windows_long_switch` should not match a dash");
+
+            bool all = true;
+            for (std::size_t i = 0; i < many_options.size; i++) {
+                    auto id = static_cast<many_option>(i);
+                    auto found = many_options.find(many_options.name(id));
+                    all = all && found && *found == id;
+            }
+            ASSERT(all, "`schema::find` should find every option of a larger schema");
+            ASSERT(!many_options.find("-zzz"),
+                "`schema::find` should not find an unknown name in a larger schema");
+
+            const char *option_names[] = {"-help", "h", "-link", "link", "l", "-verbose", "-version", "o"};
+            static_assert(options.hash() != many_options.hash());
+            ASSERT(options.hash() == clam_schema_hash(option_names, 8),
+                "`schema::hash` should agree with `clam_schema_hash`");
+
+            static_assert(applets.match_basename(std::string_view("/bin/true")).id == applet::true_);
+            auto a = applets.match_basename("/usr/local/very/long/path/to/the/bin/grep");
+            ASSERT(a && a.id == applet::grep && a.length == strlen("/usr/local/very/long/path/to/the/bin/grep"),
+                "`schema::match_basename` should match the base name of a path");
+            a = applets.match_basename("sed");
+            ASSERT(a && a.id == applet::sed,
+                "`schema::match_basename` should match a name without a directory");
+            ASSERT(!applets.match_basename("/bin/") && !applets.match_basename("/bin/ls/x") &&
+                   !applets.match_basename("/bin/lsx"),
+                "`schema::match_basename` should not match other base names");
+        }
+
+        {
+            printf("# Matcher combinators\n");
+
+            using namespace clam;
+
+            static_assert(std::is_same_v<decltype(seq(lit<"-">, lit<"-link">)), literal<"--link">>,
+                "adjacent literals should be fused");
+            static_assert(std::is_same_v<decltype(alt(lit<"--link">, lit<"-l">)),
+                                         sequence<literal<"-">, alternative<literal<"-link">, literal<"l">>>>,
+                "shared prefixes should be hoisted");
+            static_assert(std::is_same_v<decltype(alt(lit<"--link">, lit<"--list">, lit<"-l">)),
+                                         sequence<literal<"-">,
+                                                  alternative<sequence<literal<"-li">, alternative<literal<"nk">, literal<"st">>>,
+                                                              literal<"l">>>>,
+                "prefixes shared by adjacent alternatives should be hoisted");
+            static_assert(sizeof(seq(alt(lit<"--help">, lit<"-h">), many(digit), end)) == 1,
+                "stateless parsers should have no storage");
+            static_assert(seq(lit<"--">, alt(lit<"link">, lit<"l">))("--l") == 3);
+
+            auto link = seq(alt(lit<"--link">, lit<"-link">, lit<"-l">), opt(lit<"=">));
+            ASSERT(link("--link") == strlen("--link"),
+                "`alt` should match the first alternative");
+            ASSERT(link("--link=x") == strlen("--link="),
+                "`opt` should match an optional part");
+            ASSERT(link("-link") == strlen("-link"),
+                "`alt` should match the second alternative");
+            ASSERT(link("-lx") == strlen("-l"),
+                "`alt` should match the last alternative");
+            ASSERT(!link("--lin"),
+                "`alt` should not match a partial literal");
+            ASSERT(!link(""),
+                "`alt` should not match an empty string");
+
+            ASSERT(alt(lit<"-">, lit<"-v">)("-v") == 1,
+                "`alt` should prefer the first alternative that matches");
+
+            std::string_view value;
+            auto define = seq(lit<"-D">, capture(seq(alpha, many(alnum)), value), opt(seq(lit<"=">, many(fn<clam_match_alphanumeric_char>))), end);
+            ASSERT(define("-DNAME1=value") == strlen("-DNAME1=value") && value == "NAME1",
+                "`capture` should capture the matched part");
+            ASSERT(!define("-D1NAME"),
+                "`seq` should not match if one of the parts does not match");
+            ASSERT(!define("-DNAME=value!"),
+                "`end` should only match the end of the input");
+
+            ASSERT(many(any_of<"ab">)("abbac") == 4,
+                "`many` should match as many repetitions as possible");
+            ASSERT(seq(lit<"x">, many(digit))("x") == 1,
+                "`many` should match no repetitions");
+            ASSERT(seq(signed_integer10, lit<"..">, signed_integer10)("-1..+2") == strlen("-1..+2"),
+                "primitives should match like the `clam_match_*` functions");
+            ASSERT(many(seq(opt(lit<"a">), opt(lit<"b">)))("ab") == 2,
+                "`many` should stop when its parser matches nothing");
+        }
+
+        return error_code;
+}